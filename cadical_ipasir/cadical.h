@@ -11,6 +11,7 @@
 #include "interrupt.h"
 
 #include "satsolver.h"
+#include "modelsnapshot.h"
 
 namespace pedant {
 
@@ -19,6 +20,7 @@ class CadicalSolver : public SatSolver {
   CadicalSolver();
   ~CadicalSolver();
   void appendFormula(const std::vector<Clause>& formula);
+  void appendFormula(const ClauseDatabase& formula);
   void addClause(const Clause& clause);
   void assume(const std::vector<int>& assumptions);
   int solve(const std::vector<int>& assumptions);
@@ -27,6 +29,7 @@ class CadicalSolver : public SatSolver {
   std::vector<int> getFailed(const std::vector<int>& assumptions);
   std::vector<int> getValues(const std::vector<int>& variables);
   std::vector<int> getModel();
+  void getModel(ModelSnapshot& model);
   int val(int variable);
 
  private:
@@ -48,6 +51,15 @@ inline void CadicalSolver::appendFormula(const std::vector<Clause>& formula) {
   }
 }
 
+inline void CadicalSolver::appendFormula(const ClauseDatabase& formula) {
+  for (auto clause: formula) {
+    for (auto l: clause) {
+      solver.add(l);
+    }
+    solver.add(0);
+  }
+}
+
 inline void CadicalSolver::addClause(const Clause& clause) {
   for (auto l: clause) {
     solver.add(l);
@@ -110,6 +122,10 @@ inline std::vector<int> CadicalSolver::getModel() {
   return assignment;
 }
 
+inline void CadicalSolver::getModel(ModelSnapshot& model) {
+  model.reset(*this, solver.vars());
+}
+
 inline int CadicalSolver::val(int variable) {
   auto l = solver.val(variable);
   auto v = abs(l);
@@ -10,6 +10,7 @@
 
 #include "solvertypes.h"
 #include "satsolver.h"
+#include "modelsnapshot.h"
 
 
 namespace pedant {
@@ -19,6 +20,7 @@ class GlucoseSolver : public SatSolver {
  public:
   GlucoseSolver();
   void appendFormula(const std::vector<Clause>& formula);
+  void appendFormula(const ClauseDatabase& formula);
   void addClause(const Clause& clause);
   void assume(const std::vector<int>& assm);
   int solve(const std::vector<int>& assumptions);
@@ -27,6 +29,7 @@ class GlucoseSolver : public SatSolver {
   std::vector<int> getFailed(const std::vector<int>& assumptions);
   std::vector<int> getValues(const std::vector<int>& variables);
   std::vector<int> getModel();
+  void getModel(ModelSnapshot& model);
   int val(int var);
 
  private:
@@ -34,6 +37,7 @@ class GlucoseSolver : public SatSolver {
   std::vector<int> assumptions;
   int max_var=-1;
 
+  void addClause(const int* first, const int* last);
   Glucose::Lit MakeGlucoseLiteral(int literal);
   Glucose::Lit MakeGlucoseVariable(int variable);
 
@@ -61,6 +65,16 @@ inline void GlucoseSolver::appendFormula(const std::vector<Clause>& formula) {
   }  
 }
 
+inline void GlucoseSolver::appendFormula(const ClauseDatabase& formula) {
+  for (auto clause: formula) {
+    addClause(clause.begin(), clause.end());
+  }
+}
+
+inline void GlucoseSolver::addClause(const Clause& clause) {
+  addClause(clause.data(), clause.data() + clause.size());
+}
+
 inline void GlucoseSolver::assume(const std::vector<int>& assms) {
   assumptions.insert(assumptions.end(),assms.begin(),assms.end());
 }
@@ -3,9 +3,10 @@
 
 namespace pedant {
 
-void GlucoseSolver::addClause(const Clause& clause) {
+void GlucoseSolver::addClause(const int* first, const int* last) {
   Glucose::vec<Glucose::Lit> glucose_clause;
-  for (int l:clause) {
+  for (auto it = first; it != last; ++it) {
+    int l = *it;
     if (abs(l)>max_var) {
       max_var=abs(l);
     }
@@ -102,6 +103,10 @@ std::vector<int> GlucoseSolver::getModel() {
   return values;
 }
 
+void GlucoseSolver::getModel(ModelSnapshot& model) {
+  model.reset(*this, solver.model.size()-1);
+}
+
 int GlucoseSolver::val(int var) {
   const Glucose::vec<Glucose::lbool>& glucose_model=solver.model;
   return var * ((glucose_model[var] == l_True_Glucose) ? 1 : -1);
@@ -0,0 +1,308 @@
+#ifndef PEDANT_CLAUSE_DATABASE_H_
+#define PEDANT_CLAUSE_DATABASE_H_
+
+#include <assert.h>
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "solvertypes.h"
+
+namespace pedant {
+
+/**
+ * Read-only view of a clause stored in a ClauseDatabase.
+ * The view is invalidated if clauses are added to the database.
+ **/
+class ClauseView {
+
+ public:
+  using value_type = int;
+  using iterator = const int*;
+  using const_iterator = const int*;
+
+  ClauseView(const int* first, const int* last);
+
+  const int* begin() const;
+  const int* end() const;
+  size_t size() const;
+  bool empty() const;
+  int operator[](size_t i) const;
+  int back() const;
+  Clause toClause() const;
+
+ private:
+  const int* first;
+  const int* last;
+
+};
+
+/**
+ * Stores clauses in one contiguous array of literals. The literals of the i-th clause are
+ * literals[offsets[i]],...,literals[offsets[i+1]-1].
+ **/
+class ClauseDatabase {
+
+ public:
+  class const_iterator {
+   public:
+    const_iterator(const ClauseDatabase& database, size_t index);
+    ClauseView operator*() const;
+    const_iterator& operator++();
+    bool operator==(const const_iterator& other) const;
+    bool operator!=(const const_iterator& other) const;
+   private:
+    const ClauseDatabase& database;
+    size_t index;
+  };
+
+  ClauseDatabase();
+  ClauseDatabase(const std::vector<Clause>& clauses);
+  /**
+   * Takes over a literal and an offset array with the layout described above.
+   **/
+  ClauseDatabase(std::vector<int>&& literals, std::vector<size_t>&& offsets);
+
+  void addClause(const Clause& clause);
+  void addClause(const ClauseView& clause);
+  template<class InputIt> void addClause(InputIt first, InputIt last);
+  void append(const ClauseDatabase& database);
+  void append(const std::vector<Clause>& clauses);
+
+  /**
+   * Adds a literal to the clause that is currently built. The clause is only added by calling finishClause.
+   **/
+  void addLiteral(int literal);
+  void finishClause();
+
+  /**
+   * Applies "reduce" to each clause in place. The function may only remove literals from the clause it is given.
+   **/
+  template<class Function> void reduceClauses(Function reduce);
+
+  void reserve(size_t number_of_clauses, size_t number_of_literals);
+  void shrinkToFit();
+  void clear();
+
+  size_t size() const;
+  bool empty() const;
+  size_t numberOfLiterals() const;
+  ClauseView operator[](size_t i) const;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  const std::vector<int>& getLiterals() const;
+  const std::vector<size_t>& getOffsets() const;
+  std::vector<Clause> toClauses() const;
+
+ private:
+  std::vector<int> literals;
+  std::vector<size_t> offsets;
+
+};
+
+std::ostream& operator<<(std::ostream& s, const ClauseView& clause);
+std::ostream& operator<<(std::ostream& s, const ClauseDatabase& database);
+
+// Implementations
+
+inline ClauseView::ClauseView(const int* first, const int* last) : first(first), last(last) {
+}
+
+inline const int* ClauseView::begin() const {
+  return first;
+}
+
+inline const int* ClauseView::end() const {
+  return last;
+}
+
+inline size_t ClauseView::size() const {
+  return last - first;
+}
+
+inline bool ClauseView::empty() const {
+  return first == last;
+}
+
+inline int ClauseView::operator[](size_t i) const {
+  return first[i];
+}
+
+inline int ClauseView::back() const {
+  return *(last - 1);
+}
+
+inline Clause ClauseView::toClause() const {
+  return Clause(first, last);
+}
+
+inline ClauseDatabase::const_iterator::const_iterator(const ClauseDatabase& database, size_t index) : database(database), index(index) {
+}
+
+inline ClauseView ClauseDatabase::const_iterator::operator*() const {
+  return database[index];
+}
+
+inline ClauseDatabase::const_iterator& ClauseDatabase::const_iterator::operator++() {
+  index++;
+  return *this;
+}
+
+inline bool ClauseDatabase::const_iterator::operator==(const const_iterator& other) const {
+  return index == other.index;
+}
+
+inline bool ClauseDatabase::const_iterator::operator!=(const const_iterator& other) const {
+  return index != other.index;
+}
+
+inline ClauseDatabase::ClauseDatabase() : offsets(1, 0) {
+}
+
+inline ClauseDatabase::ClauseDatabase(const std::vector<Clause>& clauses) : offsets(1, 0) {
+  append(clauses);
+}
+
+inline ClauseDatabase::ClauseDatabase(std::vector<int>&& literals, std::vector<size_t>&& offsets) :
+    literals(std::move(literals)), offsets(std::move(offsets)) {
+  assert(!this->offsets.empty() && this->offsets.back() == this->literals.size());
+}
+
+inline void ClauseDatabase::addClause(const Clause& clause) {
+  addClause(clause.begin(), clause.end());
+}
+
+inline void ClauseDatabase::addClause(const ClauseView& clause) {
+  addClause(clause.begin(), clause.end());
+}
+
+template<class InputIt> void ClauseDatabase::addClause(InputIt first, InputIt last) {
+  literals.insert(literals.end(), first, last);
+  offsets.push_back(literals.size());
+}
+
+inline void ClauseDatabase::append(const ClauseDatabase& database) {
+  reserve(size() + database.size(), literals.size() + database.literals.size());
+  auto shift = literals.size();
+  literals.insert(literals.end(), database.literals.begin(), database.literals.end());
+  for (size_t i = 1; i < database.offsets.size(); i++) {
+    offsets.push_back(database.offsets[i] + shift);
+  }
+}
+
+inline void ClauseDatabase::append(const std::vector<Clause>& clauses) {
+  size_t number_of_literals = literals.size();
+  for (const auto& clause: clauses) {
+    number_of_literals += clause.size();
+  }
+  reserve(size() + clauses.size(), number_of_literals);
+  for (const auto& clause: clauses) {
+    addClause(clause);
+  }
+}
+
+inline void ClauseDatabase::addLiteral(int literal) {
+  literals.push_back(literal);
+}
+
+inline void ClauseDatabase::finishClause() {
+  offsets.push_back(literals.size());
+}
+
+template<class Function> void ClauseDatabase::reduceClauses(Function reduce) {
+  Clause clause;
+  size_t read_position = 0;
+  size_t write_position = 0;
+  for (size_t i = 0; i < size(); i++) {
+    size_t read_end = offsets[i + 1];
+    clause.assign(literals.begin() + read_position, literals.begin() + read_end);
+    reduce(clause);
+    assert(clause.size() <= read_end - read_position);
+    std::copy(clause.begin(), clause.end(), literals.begin() + write_position);
+    write_position += clause.size();
+    offsets[i + 1] = write_position;
+    read_position = read_end;
+  }
+  literals.resize(write_position);
+}
+
+inline void ClauseDatabase::reserve(size_t number_of_clauses, size_t number_of_literals) {
+  offsets.reserve(number_of_clauses + 1);
+  literals.reserve(number_of_literals);
+}
+
+inline void ClauseDatabase::shrinkToFit() {
+  offsets.shrink_to_fit();
+  literals.shrink_to_fit();
+}
+
+inline void ClauseDatabase::clear() {
+  literals.clear();
+  offsets.resize(1);
+}
+
+inline size_t ClauseDatabase::size() const {
+  return offsets.size() - 1;
+}
+
+inline bool ClauseDatabase::empty() const {
+  return offsets.size() == 1;
+}
+
+inline size_t ClauseDatabase::numberOfLiterals() const {
+  return offsets.back();
+}
+
+inline ClauseView ClauseDatabase::operator[](size_t i) const {
+  const int* data = literals.data();
+  return ClauseView(data + offsets[i], data + offsets[i + 1]);
+}
+
+inline ClauseDatabase::const_iterator ClauseDatabase::begin() const {
+  return const_iterator(*this, 0);
+}
+
+inline ClauseDatabase::const_iterator ClauseDatabase::end() const {
+  return const_iterator(*this, size());
+}
+
+inline const std::vector<int>& ClauseDatabase::getLiterals() const {
+  return literals;
+}
+
+inline const std::vector<size_t>& ClauseDatabase::getOffsets() const {
+  return offsets;
+}
+
+inline std::vector<Clause> ClauseDatabase::toClauses() const {
+  std::vector<Clause> clauses;
+  clauses.reserve(size());
+  for (auto clause: *this) {
+    clauses.push_back(clause.toClause());
+  }
+  return clauses;
+}
+
+inline std::ostream& operator<<(std::ostream& s, const ClauseView& clause) {
+  s << "[";
+  for (size_t i = 0; i < clause.size(); i++) {
+    s << (i > 0 ? ", " : "") << clause[i];
+  }
+  s << "]";
+  return s;
+}
+
+inline std::ostream& operator<<(std::ostream& s, const ClauseDatabase& database) {
+  s << "[";
+  for (size_t i = 0; i < database.size(); i++) {
+    s << (i > 0 ? ", " : "") << database[i];
+  }
+  s << "]";
+  return s;
+}
+
+}
+
+#endif // PEDANT_CLAUSE_DATABASE_H_
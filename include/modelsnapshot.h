@@ -0,0 +1,95 @@
+#ifndef PEDANT_MODELSNAPSHOT_H_
+#define PEDANT_MODELSNAPSHOT_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <assert.h>
+#include <vector>
+
+#include "satsolver.h"
+
+
+namespace pedant {
+
+/**
+ * The model of a SAT solver after a satisfiable call, cached densely by variable index.
+ * SatSolver::getModel(ModelSnapshot&) only clears the snapshot, the value of a variable is read from the solver
+ * the first time it is accessed, so a check only pays for the variables it actually reads.
+ * The solver must not be modified (no new clauses, no further solve calls) while the snapshot is in use.
+ * Like SatSolver::val, val(v) returns v if v is true and -v if v is false. The sign of the argument is ignored.
+ * Only the variables 1,...,getMaxVariable() of the solver may be accessed.
+ **/
+class ModelSnapshot {
+
+ public:
+  /**
+   * Clears the snapshot, the values of the variables 1,...,max_variable are read from solver on demand.
+   **/
+  void reset(SatSolver& solver, int max_variable);
+  int val(int variable) const;
+  std::vector<int> getValues(const std::vector<int>& variables) const;
+  /**
+   * Returns the smallest variable in first_variable,...,last_variable that is false, 0 if there is none.
+   * Reads the values of the variables up to the one returned.
+   **/
+  int findFalse(int first_variable, int last_variable) const;
+  int getMaxVariable() const;
+
+ private:
+  bool isTrue(int variable) const;
+
+  SatSolver* solver = nullptr;
+  // 1 for true, -1 for false, 0 if not read from the solver yet. Index 0 is unused.
+  mutable std::vector<int8_t> values;
+
+};
+
+// Implementations
+
+inline void ModelSnapshot::reset(SatSolver& solver_, int max_variable) {
+  solver = &solver_;
+  values.assign(max_variable + 1, 0);
+}
+
+inline bool ModelSnapshot::isTrue(int variable) const {
+  assert(solver != nullptr && variable > 0 && variable < static_cast<int>(values.size()));
+  if (variable >= static_cast<int>(values.size())) {
+    return solver->val(variable) > 0;
+  }
+  auto& value = values[variable];
+  if (value == 0) {
+    value = solver->val(variable) > 0 ? 1 : -1;
+  }
+  return value > 0;
+}
+
+inline int ModelSnapshot::val(int variable) const {
+  auto v = std::abs(variable);
+  return isTrue(v) ? v : -v;
+}
+
+inline std::vector<int> ModelSnapshot::getValues(const std::vector<int>& variables) const {
+  std::vector<int> assignment;
+  assignment.reserve(variables.size());
+  for (auto v: variables) {
+    assignment.push_back(val(v));
+  }
+  return assignment;
+}
+
+inline int ModelSnapshot::findFalse(int first_variable, int last_variable) const {
+  for (int v = first_variable; v <= last_variable; v++) {
+    if (!isTrue(v)) {
+      return v;
+    }
+  }
+  return 0;
+}
+
+inline int ModelSnapshot::getMaxVariable() const {
+  return values.empty() ? 0 : static_cast<int>(values.size()) - 1;
+}
+
+}
+
+#endif // PEDANT_MODELSNAPSHOT_H_
@@ -0,0 +1,139 @@
+#ifndef PEDANT_PARALLEL_H_
+#define PEDANT_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pedant {
+
+/**
+ * Number of worker threads to use if number_of_threads is requested, 0 means one per hardware thread.
+ **/
+unsigned numberOfWorkers(unsigned number_of_threads);
+
+/**
+ * Calls task(index, worker) for index = 0,...,number_of_tasks-1 using the given number of workers (worker = 0,...,number_of_workers-1).
+ * Idle workers take the next chunk of indices from a shared counter, thus workers that finish early take over the remaining tasks.
+ * Tasks must not depend on the order in which they are executed. The first exception thrown by a task is rethrown.
+ **/
+template<class Task> void parallelFor(size_t number_of_tasks, unsigned number_of_workers, Task task);
+
+/**
+ * Unbounded lock-free queue for exactly one producer thread and one consumer thread.
+ * The queue is a linked list whose first node is a dummy, push only touches the last node and pop only the first one.
+ **/
+template<class T> class SpscQueue {
+
+ public:
+  SpscQueue();
+  ~SpscQueue();
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+  // Producer side.
+  void push(T value);
+  // Consumer side, returns false if the queue is empty.
+  bool pop(T& value);
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    T value;
+  };
+
+  Node* head;
+  Node* tail;
+
+};
+
+// Implementations
+
+inline unsigned numberOfWorkers(unsigned number_of_threads) {
+  if (number_of_threads == 0) {
+    number_of_threads = std::thread::hardware_concurrency();
+  }
+  return std::max(1u, number_of_threads);
+}
+
+template<class Task> void parallelFor(size_t number_of_tasks, unsigned number_of_workers, Task task) {
+  number_of_workers = static_cast<unsigned>(std::min<size_t>(number_of_workers, number_of_tasks));
+  if (number_of_workers <= 1) {
+    for (size_t i = 0; i < number_of_tasks; i++) {
+      task(i, 0u);
+    }
+    return;
+  }
+  // Small chunks keep the load balanced, the lower bound keeps the contention on the counter low.
+  const size_t chunk_size = std::max<size_t>(1, std::min<size_t>(64, number_of_tasks / (8 * number_of_workers)));
+  std::atomic<size_t> next_task(0);
+  std::exception_ptr error = nullptr;
+  std::mutex error_mutex;
+  auto work = [&](unsigned worker) {
+    try {
+      size_t start;
+      while ((start = next_task.fetch_add(chunk_size)) < number_of_tasks) {
+        size_t end = std::min(start + chunk_size, number_of_tasks);
+        for (size_t i = start; i < end; i++) {
+          task(i, worker);
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      next_task = number_of_tasks;
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(number_of_workers - 1);
+  for (unsigned w = 1; w < number_of_workers; w++) {
+    workers.emplace_back(work, w);
+  }
+  work(0);
+  for (auto& worker: workers) {
+    worker.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+template<class T> SpscQueue<T>::SpscQueue() : head(new Node()), tail(head) {
+}
+
+template<class T> SpscQueue<T>::~SpscQueue() {
+  while (head != nullptr) {
+    auto next = head->next.load(std::memory_order_relaxed);
+    delete head;
+    head = next;
+  }
+}
+
+template<class T> void SpscQueue<T>::push(T value) {
+  auto node = new Node();
+  node->value = std::move(value);
+  tail->next.store(node, std::memory_order_release);
+  tail = node;
+}
+
+template<class T> bool SpscQueue<T>::pop(T& value) {
+  auto next = head->next.load(std::memory_order_acquire);
+  if (next == nullptr) {
+    return false;
+  }
+  // The first node with a value becomes the new dummy.
+  value = std::move(next->value);
+  delete head;
+  head = next;
+  return true;
+}
+
+}
+
+#endif // PEDANT_PARALLEL_H_
@@ -4,15 +4,19 @@
 #include <vector>
 
 #include "solvertypes.h"
+#include "clausedatabase.h"
 
 
 namespace pedant {
 
+class ModelSnapshot;
+
 class SatSolver {
 
  public:
   // virtual ~SatSolver();
   virtual void appendFormula(const std::vector<Clause>& formula) = 0;
+  virtual void appendFormula(const ClauseDatabase& formula) = 0;
   virtual void addClause(const Clause& clause) = 0;
   virtual void assume(const std::vector<int>& assm) = 0;
   virtual int solve(const std::vector<int>& assumptions) = 0;
@@ -21,6 +25,8 @@ class SatSolver {
   virtual std::vector<int> getFailed(const std::vector<int>& assumptions) = 0;
   virtual std::vector<int> getValues(const std::vector<int>& variables) = 0;
   virtual std::vector<int> getModel() = 0;
+  // Makes model, which is owned by the caller, read the current model from this solver, see ModelSnapshot.
+  virtual void getModel(ModelSnapshot& model) = 0;
   virtual int val(int variable) = 0;
 };
   
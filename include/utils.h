@@ -13,6 +13,7 @@
 #include <set>
 
 #include "solvertypes.h"
+#include "clausedatabase.h"
 
 namespace pedant {
 
@@ -23,25 +24,42 @@ int litFromMiniSATLit(int minisat_literal);
 int miniSATLiteral(int literal);
 std::vector<int> miniSATLiterals(const std::vector<int>& literals);
 std::vector<Clause> miniSATClauses(std::vector<Clause>& clauses);
+std::vector<Clause> miniSATClauses(const ClauseDatabase& clauses);
 int maxVarIndex(const std::vector<Clause>& clauses);
+int maxVarIndex(const ClauseDatabase& clauses);
 std::vector<Clause> clausalEncodingAND(const std::tuple<std::vector<int>,int>& and_gate_definition);
 int renameLiteral(int source_literal, int target_variable);
 int renameLiteral(int literal, const std::unordered_map<int, int>& renaming);
 void setLiteralSign(int& literal, bool sign);
 Clause renameClause(const Clause& clause, const std::unordered_map<int, int>& renaming);
 std::vector<Clause> renameFormula(const std::vector<Clause>& clauses, const std::unordered_map<int, int>& renaming);
+ClauseDatabase renameFormula(const ClauseDatabase& clauses, const std::unordered_map<int, int>& renaming);
 std::unordered_map<int, int> createRenaming(std::vector<Clause>& clauses, std::vector<int>& shared_variables, int auxiliary_start=0);
 void negateEach(std::vector<int>& literals);
 std::tuple<std::vector<Clause>, std::vector<int>> negateFormula(const std::vector<Clause>& clauses, int& max_used_variable);
+std::tuple<ClauseDatabase, std::vector<int>> negateFormula(const ClauseDatabase& clauses, int& max_used_variable);
 std::vector<Clause> clausalEncodingEquality(int first_literal, int second_literal, int switch_literal);
 template <class T> auto getKeys(T& map);
 void printVector(std::vector<int>& vec);
 std::unordered_map<int, std::vector<int>> ComputeExtendedDependencies(const std::unordered_map<int, std::vector<int>>& dependency_map);
 template<class T> std::vector<int> restrictTo(const std::vector<int>& literals, T& range);
 std::vector<int> getSupport(const Clause& conflict, const std::vector<Clause>& definition);
+void renameAuxiliaryVariables(std::vector<Clause>& definition, Circuit& definition_circuit, int first_auxiliary_variable, int& last_used_variable);
 template <class A, class B> bool restrictClauseByConstant0(Clause& clause, const A& dependencies, const B& universal_variables);
 template <class A, class B> bool restrictDefinitionByConstant0(std::vector<Clause>& definition, const A& dependencies, const B& universal_variables);
 
+// https://stackoverflow.com/questions/20511347/a-good-hash-function-for-a-vector
+class IntVectorHasher {
+ public:
+  std::size_t operator()(std::vector<int> const& vec) const {
+    std::size_t ret = vec.size();
+    for(auto& i : vec) {
+      ret ^= std::hash<int>()(i) + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+    }
+    return ret;
+  }
+};
+
 // Implementations
 
 inline int var(int literal) {
@@ -83,6 +101,20 @@ inline std::vector<Clause> miniSATClauses(std::vector<Clause>& clauses) {
   return result;
 }
 
+inline std::vector<Clause> miniSATClauses(const ClauseDatabase& clauses) {
+  std::vector<Clause> result;
+  result.reserve(clauses.size());
+  for (auto clause: clauses) {
+    Clause clause_minisat;
+    clause_minisat.reserve(clause.size());
+    for (auto literal: clause) {
+      clause_minisat.push_back(miniSATLiteral(literal));
+    }
+    result.push_back(std::move(clause_minisat));
+  }
+  return result;
+}
+
 inline int maxVarIndex(const std::vector<Clause>& clauses) {
   int maximum = 0;
   for (const auto& clause: clauses) {
@@ -93,6 +125,14 @@ inline int maxVarIndex(const std::vector<Clause>& clauses) {
   return maximum;
 }
 
+inline int maxVarIndex(const ClauseDatabase& clauses) {
+  int maximum = 0;
+  for (auto literal: clauses.getLiterals()) {
+    maximum = std::max(maximum, var(literal));
+  }
+  return maximum;
+}
+
 inline std::vector<Clause> clausalEncodingAND(const std::tuple<std::vector<int>,int>& and_gate_definition) {
   auto& [input_literals, output_literal] = and_gate_definition;
   std::vector<Clause> clauses;
@@ -143,6 +183,18 @@ inline std::vector<Clause> renameFormula(const std::vector<Clause>& clauses, con
   return renamed_clauses;
 }
 
+inline ClauseDatabase renameFormula(const ClauseDatabase& clauses, const std::unordered_map<int, int>& renaming) {
+  ClauseDatabase renamed_clauses;
+  renamed_clauses.reserve(clauses.size(), clauses.numberOfLiterals());
+  for (auto clause: clauses) {
+    for (auto literal: clause) {
+      renamed_clauses.addLiteral(renameLiteral(literal, renaming));
+    }
+    renamed_clauses.finishClause();
+  }
+  return renamed_clauses;
+}
+
 inline std::unordered_map<int, int> createRenaming(std::vector<Clause>& clauses, std::vector<int>& shared_variables, int auxiliary_start) {
   std::unordered_set<int> shared_variables_set(shared_variables.begin(), shared_variables.end());
   std::vector<int> non_shared_variables;
@@ -186,6 +238,26 @@ inline std::tuple<std::vector<Clause>, std::vector<int>> negateFormula(const std
   return std::make_tuple(formula_negated, clause_variables);
 }
 
+inline std::tuple<ClauseDatabase, std::vector<int>> negateFormula(const ClauseDatabase& formula, int& max_used_variable) {
+  ClauseDatabase formula_negated;
+  formula_negated.reserve(formula.numberOfLiterals() + 1, 2 * formula.numberOfLiterals() + formula.size());
+  std::vector<int> clause_variables;
+  clause_variables.reserve(formula.size());
+  Clause not_all_clauses_satisfied;
+  max_used_variable = (max_used_variable > 0) ? max_used_variable : maxVarIndex(formula);
+  int& clause_variable = max_used_variable;
+  for (auto clause: formula) {
+    clause_variable++;
+    clause_variables.push_back(clause_variable);
+    for (auto literal: clause) {
+      formula_negated.addClause({-literal, clause_variable});
+    }
+    not_all_clauses_satisfied.push_back(-clause_variable);
+  }
+  formula_negated.addClause(not_all_clauses_satisfied);
+  return std::make_tuple(std::move(formula_negated), clause_variables);
+}
+
 inline std::vector<Clause> clausalEncodingEquality(int first_literal, int second_literal, int switch_literal) {
   return {{-switch_literal, -first_literal, second_literal},
           {-switch_literal, first_literal, -second_literal}};
@@ -268,6 +340,32 @@ inline std::vector<int> getSupport(const Clause& conflict, const std::vector<Cla
   return std::vector<int>(support.begin(), support.end());
 }
 
+/**
+ * Renames the auxiliary variables of a definition (the variables from first_auxiliary_variable on) to fresh variables.
+ * Variables are renamed in the order of their first occurrence, thus the renaming only depends on the definition.
+ **/
+inline void renameAuxiliaryVariables(std::vector<Clause>& definition, Circuit& definition_circuit, int first_auxiliary_variable, int& last_used_variable) {
+  std::unordered_map<int, int> renaming;
+  auto rename = [&renaming, first_auxiliary_variable, &last_used_variable](int& literal) {
+    auto v = var(literal);
+    if (v < first_auxiliary_variable) {
+      return;
+    }
+    auto [it, inserted] = renaming.emplace(v, 0);
+    if (inserted) {
+      it->second = ++last_used_variable;
+    }
+    literal = literal > 0 ? it->second : -it->second;
+  };
+  for (auto& [inputs, output]: definition_circuit) {
+    std::for_each(inputs.begin(), inputs.end(), rename);
+    rename(output);
+  }
+  for (auto& clause: definition) {
+    std::for_each(clause.begin(), clause.end(), rename);
+  }
+}
+
 template <class A, class B> bool restrictClauseByConstant0(Clause& clause, const A& dependencies, const B& universal_variables) {
   int i,j;
   for (i = j = 0; i < clause.size(); i++) {
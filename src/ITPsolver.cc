@@ -9,17 +9,60 @@
 
 namespace pedant {
 
-ITPSolver::ITPSolver(std::vector<Clause>& _first_part, std::vector<Clause>& _second_part): first_part(miniSATClauses(_first_part)), second_part(miniSATClauses(_second_part)) {
+ITPSolver::ITPSolver(const ClauseDatabase& _first_part, const ClauseDatabase& _second_part): first_part(_first_part), second_part(_second_part) {
   DLOG(trace) << "First part: "  << first_part  << std::endl
               << "Second part: " << second_part << std::endl;
   max_var_index = std::max(maxVarIndex(first_part), maxVarIndex(second_part));
   interpolatingsolver = std::make_unique<InterpolatingSolver>(max_var_index);
-  interpolatingsolver->addFormula(first_part, second_part);
+  addParts();
+}
+
+ITPSolver::ITPSolver(const ClauseDatabase& shared_clauses, const std::unordered_map<int, int>& renaming, const ClauseDatabase& _first_part, const ClauseDatabase& _second_part):
+    first_part(_first_part), second_part(_second_part), shared_clauses(&shared_clauses), shared_renaming(renaming) {
+  DLOG(trace) << "First part: "  << first_part  << std::endl
+              << "Second part: " << second_part << std::endl;
+  max_var_index = std::max(maxVarIndex(first_part), maxVarIndex(second_part));
+  for (int l: shared_clauses.getLiterals()) {
+    max_var_index = std::max(max_var_index, var(renameLiteral(l, shared_renaming)));
+    max_var_index = std::max(max_var_index, var(l));
+  }
+  interpolatingsolver = std::make_unique<InterpolatingSolver>(max_var_index);
+  addParts();
+  addSharedClauses();
 }
 
 void ITPSolver::resetSolver() {
   interpolatingsolver->resetSolver(max_var_index);
-  interpolatingsolver->addFormula(first_part, second_part);
+  addParts();
+  addSharedClauses();
+}
+
+/**
+ * The MiniSAT copies of the parts only exist while they are handed to the solver.
+ **/
+void ITPSolver::addParts() {
+  auto first_part_minisat = miniSATClauses(first_part);
+  auto second_part_minisat = miniSATClauses(second_part);
+  interpolatingsolver->addFormula(first_part_minisat, second_part_minisat);
+}
+
+void ITPSolver::addSharedClauses() {
+  if (shared_clauses == nullptr) {
+    return;
+  }
+  Clause clause_minisat;
+  for (auto clause: *shared_clauses) {
+    clause_minisat.clear();
+    for (auto l: clause) {
+      clause_minisat.push_back(miniSATLiteral(l));
+    }
+    interpolatingsolver->addClause(clause_minisat, 1);
+    clause_minisat.clear();
+    for (auto l: clause) {
+      clause_minisat.push_back(miniSATLiteral(renameLiteral(l, shared_renaming)));
+    }
+    interpolatingsolver->addClause(clause_minisat, 2);
+  }
 }
 
 bool ITPSolver::addClause(Clause& clause, bool add_to_first_part) {
@@ -36,10 +79,10 @@ bool ITPSolver::addClause(Clause& clause, bool add_to_first_part) {
   auto clause_minisat = miniSATLiterals(clause);
   DLOG(trace) << "Adding miniSAT clause to part " << add_to_first_part << " " << clause_minisat << std::endl;
   if (add_to_first_part) {
-    first_part.push_back(clause_minisat);
+    first_part.addClause(clause);
     return interpolatingsolver->addClause(clause_minisat, 1);
   } else {
-    second_part.push_back(clause_minisat);
+    second_part.addClause(clause);
     return interpolatingsolver->addClause(clause_minisat, 2);
   }
 }
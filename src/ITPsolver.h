@@ -4,17 +4,24 @@
 #include <vector>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 
 #include "InterpolatingSolver.h"
 
 #include "solvertypes.h"
+#include "clausedatabase.h"
 
 namespace pedant {
 
 class ITPSolver {
   
  public:
-  ITPSolver(std::vector<Clause>& _first_part, std::vector<Clause>& _second_part);
+  ITPSolver(const ClauseDatabase& _first_part, const ClauseDatabase& _second_part);
+  /**
+   * The first part consists of shared_clauses and _first_part, the second part of shared_clauses renamed by renaming and _second_part.
+   * The shared clauses are not copied, thus they must outlive the solver.
+   **/
+  ITPSolver(const ClauseDatabase& shared_clauses, const std::unordered_map<int, int>& renaming, const ClauseDatabase& _first_part, const ClauseDatabase& _second_part);
   void resetSolver();
   bool addClause(Clause& clause, bool add_to_first_part=true);
   bool solve(std::vector<int>& assumptions, int limit=-1);
@@ -22,9 +29,15 @@ class ITPSolver {
   std::tuple<std::vector<std::tuple<std::vector<int>,int>>, std::vector<int>> getDefinition(const std::vector<int>& input_variable_ids, int output_variable_id, int offset, bool compress=true);
 
  private:
+  void addSharedClauses();
+  void addParts();
+
   std::unique_ptr<InterpolatingSolver> interpolatingsolver;
   int max_var_index;
-  std::vector<Clause> first_part, second_part;
+  // Clauses of both parts that are not shared, needed to rebuild the solver in resetSolver.
+  ClauseDatabase first_part, second_part;
+  const ClauseDatabase* shared_clauses = nullptr;
+  std::unordered_map<int, int> shared_renaming;
 };
 
 }
@@ -0,0 +1,206 @@
+#include "circuitminimizer.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "aig/gia/gia.h"
+#include "aig/gia/giaAig.h"
+#include "proof/cec/cec.h"
+
+#include "utils.h"
+#include "logging.h"
+
+using namespace ABC_NAMESPACE;
+
+namespace pedant {
+
+std::mutex& abcMutex() {
+  static std::mutex abc_mutex;
+  return abc_mutex;
+}
+
+CircuitMinimizer::CircuitMinimizer(const Configuration& config) : config(config) {
+}
+
+/**
+ * Number of literals in the clausal encoding of the circuit.
+ **/
+size_t CircuitMinimizer::encodingSize(const Circuit& circuit) {
+  size_t size = 0;
+  for (const auto& [inputs, output]: circuit) {
+    size += 3 * inputs.size() + 1;
+  }
+  return size;
+}
+
+bool CircuitMinimizer::minimize(int defined_variable, std::vector<Clause>& definition, Circuit& definition_circuit, int& last_used_variable) {
+  if (config.definition_minimization == 0 || definition_circuit.size() < static_cast<size_t>(config.definition_minimization_threshold)) {
+    return false;
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::unordered_map<int, size_t> gate_index;
+  for (size_t i = 0; i < definition_circuit.size(); i++) {
+    gate_index.emplace(var(std::get<1>(definition_circuit[i])), i);
+  }
+  if (gate_index.find(defined_variable) == gate_index.end()) {
+    return false;
+  }
+  statistics.calls++;
+
+  // Collect the gates reachable from the output in topological order and the inputs of the circuit.
+  std::vector<size_t> gate_order;
+  std::vector<int> input_variables;
+  std::unordered_set<int> seen;
+  std::vector<std::pair<int, bool>> stack{{defined_variable, false}};
+  while (!stack.empty()) {
+    auto [variable, expanded] = stack.back();
+    stack.pop_back();
+    auto it = gate_index.find(variable);
+    if (expanded) {
+      gate_order.push_back(it->second);
+      continue;
+    }
+    if (!seen.insert(variable).second) {
+      continue;
+    }
+    if (it == gate_index.end()) {
+      input_variables.push_back(variable);
+      continue;
+    }
+    stack.emplace_back(variable, true);
+    for (auto l: std::get<0>(definition_circuit[it->second])) {
+      if (seen.find(var(l)) == seen.end()) {
+        stack.emplace_back(var(l), false);
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(abcMutex());
+  Gia_Man_t* aig = Gia_ManStart(static_cast<int>(2 + input_variables.size() + 2 * encodingSize(definition_circuit)));
+  Gia_ManHashAlloc(aig);
+  std::unordered_map<int, int> aig_literal;
+  for (auto v: input_variables) {
+    aig_literal[v] = Gia_ManAppendCi(aig);
+  }
+  for (auto i: gate_order) {
+    const auto& [inputs, output] = definition_circuit[i];
+    int literal = 1;
+    for (auto l: inputs) {
+      literal = Gia_ManHashAnd(aig, literal, Abc_LitNotCond(aig_literal.at(var(l)), l < 0));
+    }
+    aig_literal[var(output)] = Abc_LitNotCond(literal, output < 0);
+  }
+  Gia_ManAppendCo(aig, aig_literal.at(defined_variable));
+  Gia_ManHashStop(aig);
+
+  auto replace = [&aig](Gia_Man_t* optimized) {
+    if (optimized != nullptr) {
+      Gia_ManStop(aig);
+      aig = optimized;
+    }
+  };
+  replace(Gia_ManCleanup(aig));
+  if (config.definition_minimization >= 2) {
+    replace(Gia_ManCompress2(aig, 1, 0));
+  }
+  if (config.definition_minimization >= 3) {
+    replace(Gia_ManBalance(aig, 0, 0, 0));
+  }
+  if (config.definition_minimization >= 4) {
+    Cec_ParFra_t parameters;
+    Cec_ManFraSetDefaultParams(&parameters);
+    replace(Cec_ManSatSweeping(aig, &parameters, 1));
+  }
+
+  // Convert back. Chains of uncomplemented AND nodes with a single fanout are merged into one gate.
+  auto number_of_objects = Gia_ManObjNum(aig);
+  std::vector<int> references(number_of_objects, 0);
+  Gia_Obj_t* object;
+  int i;
+  Gia_ManForEachAnd(aig, object, i) {
+    references[Gia_ObjFaninId0(object, i)]++;
+    references[Gia_ObjFaninId1(object, i)]++;
+  }
+  std::vector<int> variable_of(number_of_objects, 0);
+  Gia_ManForEachCi(aig, object, i) {
+    variable_of[Gia_ObjId(aig, object)] = input_variables[i];
+  }
+  auto output = Gia_ManCo(aig, 0);
+  auto driver = Gia_ObjFaninId0p(aig, output);
+  auto output_literal = Gia_ObjFaninC0(output) ? -defined_variable : defined_variable;
+  Circuit optimized_circuit;
+  int next_variable = last_used_variable;
+  bool constant_input = false;
+  if (driver == 0) {
+    optimized_circuit.emplace_back(std::vector<int>{}, -output_literal);
+  } else if (Gia_ObjIsCi(Gia_ManObj(aig, driver))) {
+    optimized_circuit.emplace_back(std::vector<int>{variable_of[driver]}, output_literal);
+  } else {
+    references[driver]++;
+    // Gate inputs as AIG literals, only for the nodes that become gates.
+    std::vector<std::vector<int>> gate_inputs(number_of_objects);
+    std::vector<char> is_gate(number_of_objects, 0);
+    is_gate[driver] = 1;
+    std::vector<int> fanins;
+    for (int id = number_of_objects - 1; id > 0; id--) {
+      if (!is_gate[id]) {
+        continue;
+      }
+      auto gate_object = Gia_ManObj(aig, id);
+      fanins = {Gia_ObjFaninLit0(gate_object, id), Gia_ObjFaninLit1(gate_object, id)};
+      while (!fanins.empty()) {
+        auto fanin = fanins.back();
+        fanins.pop_back();
+        auto fanin_id = Abc_Lit2Var(fanin);
+        auto fanin_object = Gia_ManObj(aig, fanin_id);
+        if (!Abc_LitIsCompl(fanin) && Gia_ObjIsAnd(fanin_object) && references[fanin_id] == 1) {
+          fanins.push_back(Gia_ObjFaninLit0(fanin_object, fanin_id));
+          fanins.push_back(Gia_ObjFaninLit1(fanin_object, fanin_id));
+        } else {
+          constant_input |= (fanin_id == 0);
+          gate_inputs[id].push_back(fanin);
+          if (Gia_ObjIsAnd(fanin_object)) {
+            is_gate[fanin_id] = 1;
+          }
+        }
+      }
+    }
+    for (int id = 1; id < number_of_objects && !constant_input; id++) {
+      if (!is_gate[id]) {
+        continue;
+      }
+      std::vector<int> inputs;
+      for (auto fanin: gate_inputs[id]) {
+        auto v = variable_of[Abc_Lit2Var(fanin)];
+        inputs.push_back(Abc_LitIsCompl(fanin) ? -v : v);
+      }
+      if (id == driver) {
+        optimized_circuit.emplace_back(inputs, output_literal);
+      } else {
+        variable_of[id] = ++next_variable;
+        optimized_circuit.emplace_back(inputs, variable_of[id]);
+      }
+    }
+  }
+  Gia_ManStop(aig);
+
+  bool improved = !constant_input && encodingSize(optimized_circuit) < encodingSize(definition_circuit);
+  if (improved) {
+    DLOG(trace) << "Definition of " << defined_variable << " minimized from " << definition_circuit.size() << " to " << optimized_circuit.size() << " gates." << std::endl;
+    statistics.minimized++;
+    statistics.gates_before += definition_circuit.size();
+    statistics.gates_after += optimized_circuit.size();
+    last_used_variable = next_variable;
+    definition.clear();
+    for (const auto& gate: optimized_circuit) {
+      auto gate_clauses = clausalEncodingAND(gate);
+      definition.insert(definition.end(), gate_clauses.begin(), gate_clauses.end());
+    }
+    definition_circuit = std::move(optimized_circuit);
+  }
+  statistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return improved;
+}
+
+}
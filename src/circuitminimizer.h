@@ -0,0 +1,60 @@
+#ifndef PEDANT_CIRCUITMINIMIZER_H_
+#define PEDANT_CIRCUITMINIMIZER_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "solvertypes.h"
+#include "configuration.h"
+
+namespace pedant {
+
+/**
+ * ABC keeps global state, thus all calls into ABC (interpolation and circuit minimization) must hold this mutex.
+ **/
+std::mutex& abcMutex();
+
+/**
+ * Optimizes definition circuits with ABC. The circuit is turned into an AIG, which is optimized by the passes
+ * selected by config.definition_minimization:
+ * 1: structural hashing, 2: in addition rewriting, 3: in addition balancing, 4: in addition SAT sweeping.
+ * The result is converted back into (multi-input) AND gates with fresh output variables.
+ **/
+class CircuitMinimizer {
+
+ public:
+  struct Statistics {
+    // Circuits that were passed to ABC, those left unchanged due to the configuration are not counted.
+    size_t calls = 0;
+    size_t minimized = 0;
+    // Gates of the definitions that were replaced, before and after the optimization.
+    size_t gates_before = 0;
+    size_t gates_after = 0;
+    double seconds = 0;
+  };
+
+  CircuitMinimizer(const Configuration& config);
+  /**
+   * Optimizes the circuit of a definition of defined_variable, the circuit's output is defined_variable or its negation.
+   * If the optimized circuit has a smaller clausal encoding, the definition and its circuit are replaced and true is returned.
+   * Circuits with less than config.definition_minimization_threshold gates are left unchanged.
+   **/
+  bool minimize(int defined_variable, std::vector<Clause>& definition, Circuit& definition_circuit, int& last_used_variable);
+  const Statistics& getStatistics() const;
+
+ private:
+  static size_t encodingSize(const Circuit& circuit);
+
+  const Configuration& config;
+  Statistics statistics;
+
+};
+
+inline const CircuitMinimizer::Statistics& CircuitMinimizer::getStatistics() const {
+  return statistics;
+}
+
+}
+
+#endif // PEDANT_CIRCUITMINIMIZER_H_
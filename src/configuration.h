@@ -9,6 +9,7 @@ namespace pedant {
 enum SatSolverType {Cadical, Glucose};
 enum ConflictStrategy {Core, MinSeparator};
 enum DefaultStrategy {Values, Functions};
+enum DefinitionEngine {Interpolation, CubeEnumeration, Race};
 
 struct Configuration {
   bool apply_dependency_schemes = true;
@@ -17,6 +18,9 @@ struct Configuration {
   bool check_definability_of_innermost_existentials = false;
   bool extended_dependencies = true;
   bool dynamic_dependencies = true;
+  // Represent the extended dependencies of the undefined variables by bitsets if the formula is small and dense enough.
+  // The bitsets take at most as much memory as materialized extended dependencies would.
+  bool dependency_bitsets = false;
   bool always_add_arbiter_clause = false;
   bool definitions = true;
   bool conditional_definitions = false;
@@ -26,12 +30,41 @@ struct Configuration {
   bool allow_arbiters_in_forcing_clauses = false;
   bool replace_arbiters_in_separators = true;
 
+  // Number of threads for the RRS dependency computation, 0 uses one thread per hardware thread.
+  int rrs_threads = 1;
+
 
   bool use_conflict_limit_unate_solver = false;
   int conflict_limit_unate_solver = 1000;
 
   int conflict_limit_definability_checker = 1000;
+  // Number of threads for the definability checks in Solver::checkDefined, 0 uses one thread per hardware thread.
+  int definability_threads = 1;
   int incremental_definability_max_iterations = 2;
+  // Wall-clock time in milliseconds for the initial definability checks, which are then ordered by their estimated payoff
+  // and use adaptive conflict limits, see DefinabilityScheduler. 0 checks all variables with the fixed limits above.
+  int definability_time_budget = 0;
+  // With a time budget, the variables left over are re-checked every definability_recheck_interval conflicts (0: never)
+  // for definability_recheck_budget milliseconds.
+  int definability_recheck_interval = 100;
+  int definability_recheck_budget = 20;
+  // Check the variables with new reduced forcing clauses in a background thread during the CEGIS loop, see DefinabilityWorker.
+  bool background_definability = false;
+  // Keep the matrix only once in the definability checker and introduce selectors on demand, at the cost of repeating some checks.
+  // The cube enumeration of the cubes and race engines needs a second copy of the matrix nevertheless.
+  bool lean_definability_encoding = false;
+  // Remember the results of definability checks and the extracted definitions, see DefinabilityChecker.
+  // A result "undefined within conflict limit L" is reused for queries with limit at most L until a clause is added
+  // (the clause epoch changes), so a variable is not checked again with the same or a smaller limit in between.
+  bool definability_cache = false;
+  // Backend for extracting definitions. A race runs cube enumeration next to interpolation and keeps the smaller circuit.
+  DefinitionEngine definition_engine = Interpolation;
+  // Time in milliseconds that cube enumeration may take in a race.
+  int definition_race_budget = 100;
+  // Optimize definition circuits with ABC, 0: off, 1: structural hashing, 2: +rewriting, 3: +balancing, 4: +SAT sweeping.
+  int definition_minimization = 0;
+  // Only circuits with at least this many gates are optimized.
+  int definition_minimization_threshold = 16;
 
   int def_limit = 1;
 
@@ -49,7 +82,14 @@ struct Configuration {
   bool extract_aag_model = false;
   std::string aag_model_filename = "";
 
+  bool use_snapshot = false;
+  std::string snapshot_filename = "";
+
   ConflictStrategy sup_strat = MinSeparator;
+  // Number of falsified matrix clauses whose support is computed after a failed validity check, the smallest support is used.
+  int falsified_clause_candidates = 1;
+  // Maximal number of counterexamples that are extracted for one arbiter assignment before the arbiter solver is called again.
+  int counterexamples_per_iteration = 1;
 
   // SatSolverType background_solver = Cadical;
 
@@ -16,7 +16,7 @@ ConsistencyChecker::ConsistencyChecker( const DependencyContainer& dependencies,
                                         last_used_variable(last_used_variable), shared_data(shared_data), config(config), 
                                         supporttracker(universal_variables, dependencies, last_used_variable, shared_data, config), dependencies(dependencies) {
   consistency_solver = giveSolverInstance(config.consistency_solver);
-  supporttracker.setSatSolver(consistency_solver);
+  supporttracker.setModel(consistency_model);
   // Create ordered map to ensure deterministic order of iteration.
   for (auto variable: existential_variables) {
     initVariableData(variable);
@@ -110,18 +110,19 @@ bool ConsistencyChecker::checkConsistency(const std::vector<int>& arbiter_assump
 
   bool consistent = (result == 20);
   if (!consistent) {
+    consistency_solver->getModel(consistency_model);
     #ifndef NDEBUG //If Loggig is disabled we do not need to compute these assignments
       DLOG(trace) << "Model of inconsistency check: " << consistency_solver->getModel() << std::endl;
-      universal_counterexample = consistency_solver->getValues(universal_variables);
+      universal_counterexample = consistency_model.getValues(universal_variables);
       DLOG(trace) << "Universal counterexample: " << universal_counterexample << std::endl;
     #endif
     auto conflicted_variable = getInconsistentExistentialVariable();
 
     if (config.sup_strat == Core) {
       #ifdef NDEBUG
-        universal_counterexample = consistency_solver->getValues(universal_variables);
+        universal_counterexample = consistency_model.getValues(universal_variables);
       #endif
-      arbiter_counterexample = consistency_solver->getValues(arbiter_assumptions);
+      arbiter_counterexample = consistency_model.getValues(arbiter_assumptions);
       complete_universal_counterexample = universal_counterexample;
       auto existential_dependencies = dependencies.getExistentialDependencies(conflicted_variable);//not very efficient
 
@@ -129,7 +130,7 @@ bool ConsistencyChecker::checkConsistency(const std::vector<int>& arbiter_assump
         auto& v_data = variable_data.at(variable);
         variable = v_data.literal_variables[true];
       });
-      auto existential_counterexample_translated = consistency_solver->getValues(existential_dependencies);
+      auto existential_counterexample_translated = consistency_model.getValues(existential_dependencies);
       std::for_each(existential_counterexample_translated.begin(), existential_counterexample_translated.end(), 
         [this](int &lit) { 
           int variable = lit > 0 ? lit : -lit - 1;
@@ -149,14 +150,14 @@ bool ConsistencyChecker::checkConsistency(const std::vector<int>& arbiter_assump
     DLOG(trace) << "Arbiter support: " << arbiter_support << std::endl;
 
     existential_counterexample.clear();
-    for (auto l: consistency_solver->getValues(existential_support)) {
+    for (auto l: consistency_model.getValues(existential_support)) {
       assert(l > 0);
       auto original_literal = literal_variable_to_literal[l];
       existential_counterexample.push_back(original_literal);
     }
-    universal_counterexample = consistency_solver->getValues(universal_support);
-    arbiter_counterexample = consistency_solver->getValues(arbiter_support);
-    complete_universal_counterexample = consistency_solver->getValues(universal_variables);
+    universal_counterexample = consistency_model.getValues(universal_support);
+    arbiter_counterexample = consistency_model.getValues(arbiter_support);
+    complete_universal_counterexample = consistency_model.getValues(universal_variables);
   } else {
     DLOG(trace) << "Consistency check passed." << std::endl;
     DLOG(trace) << "Failed disjunction terminals: " << consistency_solver->getFailed(disjunction_terminals) << std::endl;
@@ -282,7 +283,7 @@ Clause ConsistencyChecker::translateClause(const Clause& clause) {
 int ConsistencyChecker::getInconsistentExistentialVariable() {
   std::vector<int> conflicted_variables;
   // Determine existential variables that are conflicted.
-  for (auto l: consistency_solver->getValues(conflict_variables)) {
+  for (auto l: consistency_model.getValues(conflict_variables)) {
     if (l > 0) {
       conflicted_variables.push_back(conflict_variable_to_variable[l]);
     }
@@ -79,6 +79,8 @@ class ConsistencyChecker {
 
   // CadicalSolver consistency_solver;
   std::shared_ptr<SatSolver> consistency_solver;
+  // Model of the last failed consistency check, read by the support tracker and when extracting counterexamples.
+  ModelSnapshot consistency_model;
   int& last_used_variable;
   const Configuration& config;
   SupportTracker supporttracker;
@@ -115,7 +117,7 @@ inline std::vector<int> ConsistencyChecker::getAssignment(std::vector<int>& exis
   std::vector<int> assignment;
   for (auto v: existential_variables) {
     auto& vd = variable_data.at(v);
-    bool negated = (consistency_solver->val(vd.literal_variables[false]) > 0);
+    bool negated = (consistency_model.val(vd.literal_variables[false]) > 0);
     assignment.push_back((v ^ -negated) + negated);
   }
   return assignment;
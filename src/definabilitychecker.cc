@@ -4,25 +4,50 @@
 #include <assert.h>
 
 #include <algorithm>
-#include <map>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <iostream>
 
 #include "utils.h"
 #include "logging.h"
 
 #include "solver_generator.h"
+#include "circuitminimizer.h"
 
 namespace pedant {
 
-DefinabilityChecker::DefinabilityChecker( std::vector<int>& universal_variables, const std::vector<int>& existential_variables, 
-                                          std::vector<Clause>& matrix, int& last_used_variable, const Configuration& config, bool compress) : 
-                                          last_used_variable(last_used_variable), compress(compress), config(config) {
+// Marks the checks in its scope as nested.
+struct NestedQuery {
+  NestedQuery(bool& nested_query) : nested_query(nested_query) {
+    nested_query = true;
+  }
+  ~NestedQuery() {
+    nested_query = false;
+  }
+  bool& nested_query;
+};
+
+static std::vector<int> sortedCopy(const std::vector<int>& literals) {
+  std::vector<int> sorted_literals = literals;
+  if (!std::is_sorted(sorted_literals.begin(), sorted_literals.end())) {
+    std::sort(sorted_literals.begin(), sorted_literals.end());
+  }
+  return sorted_literals;
+}
+
+DefinabilityChecker::DefinabilityChecker( const std::vector<int>& universal_variables, const std::vector<int>& existential_variables, 
+                                          const ClauseDatabase& matrix, int& last_used_variable, const Configuration& config, bool compress) : 
+                                          universal_variables(universal_variables), existential_variables(existential_variables), matrix(matrix),
+                                          last_used_variable(last_used_variable), compress(compress), lean(config.lean_definability_encoding), config(config) {
   if (!config.definitions) {
     return;
   }
-  backbone_solver = giveSolverInstance(config.definability_solver);
-  fast_solver = giveSolverInstance(config.definability_solver);
+  if (!lean) {
+    backbone_solver = giveSolverInstance(config.definability_solver);
+    fast_solver = giveSolverInstance(config.definability_solver);
+  }
   // auto existential_variables = getKeys(dependency_map);
   auto max_existential = existential_variables.empty() ? 0 : *std::max_element(existential_variables.begin(), existential_variables.end());
   auto max_universal = universal_variables.empty() ? 0 : *std::max_element(universal_variables.begin(), universal_variables.end());
@@ -39,35 +64,40 @@ DefinabilityChecker::DefinabilityChecker( std::vector<int>& universal_variables,
     renaming[v] = renamed_v;
     renaming_inverse[renamed_v] = v;
   }
-  auto first_part = matrix;
-  auto second_part = renameFormula(matrix, renaming);
-  // Create dictionary of selector variables to activate equality v == renaming[v].
-  // Append equality clauses to copy of formula.
-  for (auto& [v, v_renamed]: std::map<int, int>(renaming.begin(), renaming.end())) {
-    int selector = ++last_used_variable;
-    variable_to_equality_selector[v] = selector;
-    auto equality_clauses = clausalEncodingEquality(v, v_renamed, selector);
-    second_part.insert(second_part.end(), equality_clauses.begin(), equality_clauses.end());
+  // The interpolating solver reads the matrix directly, the parts only contain the selector clauses.
+  ClauseDatabase first_part, second_part;
+  // Selector variables to activate equality v == renaming[v] are introduced on demand, 0 marks a selector that does not exist yet.
+  for (const auto& [v, v_renamed]: renaming) {
+    variable_to_equality_selector[v] = 0;
   }
   // Assumptions for switching literals on and off must be local to each part, so we have to define new selectors.
-  for (const auto& v: existential_variables) {
-    auto on_selector = ++last_used_variable;
-    variable_to_on_selector[v] = on_selector;
-    first_part.push_back(Clause{-on_selector, v});
-    auto off_selector = ++last_used_variable;
-    variable_to_off_selector[v] = off_selector;
-    second_part.push_back(Clause{-off_selector, -renaming[v]});
+  // In the lean encoding they are only introduced for the variables whose definability is checked.
+  if (!lean) {
+    for (const auto& v: existential_variables) {
+      auto on_selector = ++last_used_variable;
+      variable_to_on_selector[v] = on_selector;
+      first_part.addClause(Clause{-on_selector, v});
+      auto off_selector = ++last_used_variable;
+      variable_to_off_selector[v] = off_selector;
+      second_part.addClause(Clause{-off_selector, -renaming[v]});
+    }
   }
   // Initialize SAT solvers.
-  interpolating_solver = std::make_unique<ITPSolver>(first_part, second_part);
-  fast_solver->appendFormula(first_part);
-  fast_solver->appendFormula(second_part);
-  backbone_solver->appendFormula(matrix);
+  interpolating_solver = std::make_unique<ITPSolver>(matrix, renaming, first_part, second_part);
+  if (!lean) {
+    fast_solver->appendFormula(matrix);
+    fast_solver->appendFormula(renameFormula(matrix, renaming));
+    fast_solver->appendFormula(first_part);
+    fast_solver->appendFormula(second_part);
+    backbone_solver->appendFormula(matrix);
+  }
 }
 
 
 DefinabilityChecker::DefinabilityChecker(DefinabilityChecker&& checker, int& last_used_variable, const Configuration& config) : 
-      last_used_variable(last_used_variable), config(config), compress(checker.compress), 
+      universal_variables(std::move(checker.universal_variables)), existential_variables(std::move(checker.existential_variables)),
+      matrix(checker.matrix), added_clauses(std::move(checker.added_clauses)),
+      last_used_variable(last_used_variable), compress(checker.compress), lean(checker.lean),
       renaming(std::move(checker.renaming)),
       renaming_inverse(std::move(checker.renaming_inverse)),
       variable_to_equality_selector(std::move(checker.variable_to_equality_selector)),
@@ -75,7 +105,17 @@ DefinabilityChecker::DefinabilityChecker(DefinabilityChecker&& checker, int& las
       variable_to_off_selector(std::move(checker.variable_to_off_selector)),
       backbone_solver(std::move(checker.backbone_solver)),
       fast_solver(std::move(checker.fast_solver)),
-      interpolating_solver(std::move(checker.interpolating_solver)) {  
+      enumeration_solver(std::move(checker.enumeration_solver)),
+      interpolating_solver(std::move(checker.interpolating_solver)),
+      reset_interpolating_solver(checker.reset_interpolating_solver), config(config) {  
+}
+
+DefinabilityChecker::DefinabilityChecker(const DefinabilityChecker& checker, int& last_used_variable) :
+      DefinabilityChecker(checker.universal_variables, checker.existential_variables, checker.matrix, last_used_variable, checker.config, checker.compress) {
+  for (auto clause_view: checker.added_clauses) {
+    auto clause = clause_view.toClause();
+    addClause(clause);
+  }
 }
 
 
@@ -87,7 +127,9 @@ void DefinabilityChecker::addVariable(int variable, bool shared) {
     auto eq_selector = ++last_used_variable;
     variable_to_equality_selector[variable] = eq_selector;
     auto equality_clauses = clausalEncodingEquality(variable, variable_alias, eq_selector);
-    fast_solver->appendFormula(equality_clauses);
+    if (fast_solver) {
+      fast_solver->appendFormula(equality_clauses);
+    }
     for (auto& clause: equality_clauses) {
       interpolating_solver->addClause(clause, false);
     }
@@ -98,8 +140,12 @@ void DefinabilityChecker::addClause(Clause& clause) {
   if (!config.definitions) {
     return;
   }
+  added_clauses.addClause(clause);
+  clause_epoch++;
   interpolating_solver->addClause(clause);
-  fast_solver->addClause(clause);
+  if (fast_solver) {
+    fast_solver->addClause(clause);
+  }
   // Add variables to renaming if necessary.
   for (auto l: clause) {
     auto v = var(l);
@@ -109,11 +155,151 @@ void DefinabilityChecker::addClause(Clause& clause) {
   }
   auto renamed_clause = renameClause(clause, renaming);
   interpolating_solver->addClause(renamed_clause, false);
-  fast_solver->addClause(renamed_clause);
-  backbone_solver->addClause(clause);
+  if (!lean) {
+    fast_solver->addClause(renamed_clause);
+    backbone_solver->addClause(clause);
+  }
+  if (enumeration_solver) {
+    enumeration_solver->addClause(clause);
+  }
+}
+
+/**
+ * Returns the selector for the equality of variable and its copy in the second part, 0 if there is none.
+ * The selector and the equality clauses are introduced on the first request.
+ **/
+int DefinabilityChecker::getEqualitySelector(int variable) {
+  auto it = variable_to_equality_selector.find(variable);
+  if (it == variable_to_equality_selector.end()) {
+    return 0;
+  }
+  if (it->second == 0) {
+    it->second = ++last_used_variable;
+    auto equality_clauses = clausalEncodingEquality(variable, renaming.at(variable), it->second);
+    if (fast_solver) {
+      fast_solver->appendFormula(equality_clauses);
+    }
+    for (auto& clause: equality_clauses) {
+      interpolating_solver->addClause(clause, false);
+    }
+  }
+  return it->second;
+}
+
+/**
+ * Appends the equality selectors of the defining variables that do not occur in the assumptions to selectors.
+ * The selectors for a set of defining variables are cached, since the same sets are checked repeatedly.
+ **/
+void DefinabilityChecker::addEqualitySelectors(const std::vector<int>& defining_variables, const std::vector<int>& assumptions, std::vector<int>& selectors) {
+  auto it = equality_selector_cache.find(defining_variables);
+  if (it == equality_selector_cache.end()) {
+    if (equality_selector_cache_size > max_equality_selector_cache_size) {
+      equality_selector_cache.clear();
+      equality_selector_cache_size = 0;
+    }
+    EqualitySelectors entry;
+    for (auto variable: defining_variables) {
+      auto selector = getEqualitySelector(variable);
+      if (selector != 0) {
+        entry.variables.push_back(variable);
+        entry.selectors.push_back(selector);
+      }
+    }
+    equality_selector_cache_size += defining_variables.size() + 2 * entry.selectors.size();
+    it = equality_selector_cache.emplace(defining_variables, std::move(entry)).first;
+  }
+  const auto& entry = it->second;
+  if (assumptions.empty()) {
+    selectors.insert(selectors.end(), entry.selectors.begin(), entry.selectors.end());
+    return;
+  }
+  std::unordered_set<int> assumption_variables;
+  for (auto l: assumptions) {
+    assumption_variables.insert(var(l));
+  }
+  for (size_t i = 0; i < entry.variables.size(); i++) {
+    if (assumption_variables.find(entry.variables[i]) == assumption_variables.end()) {
+      selectors.push_back(entry.selectors[i]);
+    }
+  }
+}
+
+void DefinabilityChecker::startNestedChecks(const std::vector<int>& defining_variables) {
+  nested_defining_variables = defining_variables;
+  nested_selector = ++last_used_variable;
+  for (auto variable: defining_variables) {
+    auto selector = getEqualitySelector(variable);
+    if (selector != 0) {
+      Clause clause{-nested_selector, selector};
+      addPrefixSelectorClause(clause);
+    }
+  }
+}
+
+void DefinabilityChecker::addNestedDefiningVariable(int variable) {
+  assert(nested_selector != 0);
+  nested_defining_variables.push_back(variable);
+  auto previous_selector = nested_selector;
+  nested_selector = ++last_used_variable;
+  Clause chain_clause{-nested_selector, previous_selector};
+  addPrefixSelectorClause(chain_clause);
+  auto selector = getEqualitySelector(variable);
+  if (selector != 0) {
+    Clause clause{-nested_selector, selector};
+    addPrefixSelectorClause(clause);
+  }
+}
+
+void DefinabilityChecker::endNestedChecks() {
+  nested_defining_variables = std::vector<int>();
+  nested_selector = 0;
+}
+
+void DefinabilityChecker::addPrefixSelectorClause(Clause& clause) {
+  if (fast_solver) {
+    fast_solver->addClause(clause);
+  }
+  interpolating_solver->addClause(clause, false);
+}
+
+std::tuple<bool, std::vector<int>> DefinabilityChecker::checkDefinabilityNested(int defined_variable, const std::vector<int>& assumptions, int limit) {
+  DLOG(trace) << "Checking for definition of " << defined_variable << " in terms of " << nested_defining_variables.size() << " nested variables." << std::endl;
+  NestedQuery query(nested_query);
+  if (!checkDefinedInterpolate(nested_defining_variables, defined_variable, assumptions, limit)) {
+    return std::make_tuple(false, std::vector<int>{});
+  }
+  auto failed_assumptions = getFailed(assumptions);
+  std::sort(failed_assumptions.begin(), failed_assumptions.end());
+  return std::make_tuple(true, failed_assumptions);
+}
+
+std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::getDefinitionNested(int defined_variable, const std::vector<int>& assumptions) {
+  NestedQuery query(nested_query);
+  return computeDefinition(nested_defining_variables, defined_variable, assumptions);
+}
+
+/**
+ * Returns the selectors that switch the defined variable on in the first and off in the second part.
+ * In the lean encoding the selectors are introduced on demand.
+ **/
+std::tuple<int, int> DefinabilityChecker::getOnOffSelectors(int variable) {
+  if (lean && variable_to_on_selector.find(variable) == variable_to_on_selector.end()) {
+    auto on_selector = ++last_used_variable;
+    variable_to_on_selector[variable] = on_selector;
+    Clause on_clause{-on_selector, variable};
+    interpolating_solver->addClause(on_clause);
+    auto off_selector = ++last_used_variable;
+    variable_to_off_selector[variable] = off_selector;
+    Clause off_clause{-off_selector, -renaming.at(variable)};
+    interpolating_solver->addClause(off_clause, false);
+  }
+  return std::make_tuple(variable_to_on_selector[variable], variable_to_off_selector[variable]);
 }
 
 std::tuple<bool, std::vector<Clause>, std::vector<int>> DefinabilityChecker::checkForced(int variable, const std::vector<int>& assumptions) {
+  if (lean) {
+    return checkForcedInterpolating(variable, assumptions);
+  }
   backbone_solver->assume(assumptions);
   backbone_solver->assume({ variable });
   auto solver_result = backbone_solver->solve();
@@ -137,6 +323,23 @@ std::tuple<bool, std::vector<Clause>, std::vector<int>> DefinabilityChecker::che
   }
 }
 
+/**
+ * Same as checkForced but uses the interpolating solver. Without selectors, the second part is just a renamed copy of the first part.
+ **/
+std::tuple<bool, std::vector<Clause>, std::vector<int>> DefinabilityChecker::checkForcedInterpolating(int variable, const std::vector<int>& assumptions) {
+  for (auto literal: {variable, -variable}) {
+    std::vector<int> assumptions_literal = assumptions;
+    assumptions_literal.push_back(literal);
+    if (!interpolating_solver->solve(assumptions_literal)) {
+      std::vector<int> core_assumptions = assumptions;
+      auto core = getConflict(core_assumptions);
+      std::vector<Clause> definition{{-literal}};
+      return std::make_tuple(true, definition, core);
+    }
+  }
+  return std::make_tuple(false, std::vector<Clause>{}, std::vector<int>{});
+}
+
 std::vector<int> DefinabilityChecker::getConflict(std::vector<int>& assumptions) {
   auto conflict = interpolating_solver->getConflict();
   negateEach(conflict);
@@ -152,7 +355,10 @@ std::vector<int> DefinabilityChecker::getConflict(std::vector<int>& assumptions)
 }
 
 std::tuple<std::vector<Clause>,std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::getDefinitionInterpolant(const std::vector<int>& defining_variables, int defined_variable) {
+  // Interpolants are simplified with ABC, thus replicas must not compute interpolants concurrently.
+  std::unique_lock<std::mutex> lock(abcMutex());
   auto [definitions, _] = interpolating_solver->getDefinition(defining_variables, defined_variable, last_used_variable, compress);
+  lock.unlock();
   std::vector<Clause> clausal_encoding_definitions;
   for (auto& definition: definitions) {
     auto clauses_definition = clausalEncodingAND(definition);
@@ -165,8 +371,26 @@ std::tuple<bool, std::vector<int>> DefinabilityChecker::checkDefinability(const
   DLOG(trace) << "Checking for definition of " << defined_variable << " in terms of " << defining_variables << std::endl;
   DLOG(trace) << "Assumptions: " << assumptions << std::endl;
 
+  std::vector<int> sorted_defining_variables, sorted_assumptions;
+  if (config.definability_cache) {
+    sorted_defining_variables = sortedCopy(defining_variables);
+    sorted_assumptions = sortedCopy(assumptions);
+    auto cached_definition = findCachedDefinition(defined_variable, sorted_defining_variables, sorted_assumptions, minimize_assumptions);
+    if (cached_definition) {
+      DLOG(trace) << "Cached definition of " << defined_variable << " under " << cached_definition->assumptions << std::endl;
+      return std::make_tuple(true, cached_definition->assumptions);
+    }
+    if (isCachedUndefined(defined_variable, sorted_defining_variables, sorted_assumptions, limit)) {
+      DLOG(trace) << "Variable " << defined_variable << " is known to be undefined." << std::endl;
+      return std::make_tuple(false, std::vector<int>{} );
+    }
+  }
+
   bool is_defined = checkDefinedInterpolate(defining_variables, defined_variable, assumptions, limit);
   if (!is_defined) {
+    if (config.definability_cache) {
+      cacheUndefined(defined_variable, CachedUndefined{std::move(sorted_defining_variables), std::move(sorted_assumptions), limit, clause_epoch});
+    }
     return std::make_tuple(false, std::vector<int>{} );
   }
   // There is a definition, extract the failed assumptions, and (possibly) minimize.
@@ -187,10 +411,116 @@ std::tuple<bool, std::vector<int>> DefinabilityChecker::checkDefinability(const
     }
   }
   std::sort(failed_assumptions.begin(), failed_assumptions.end());
+  if (minimize_assumptions) {
+    last_minimized_variable = defined_variable;
+    last_minimized_assumptions = failed_assumptions;
+  }
   return std::make_tuple(true, failed_assumptions);
 }
 
 std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::getDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions) {
+  if (!config.definability_cache) {
+    return computeDefinition(defining_variables, defined_variable, assumptions);
+  }
+  auto sorted_defining_variables = sortedCopy(defining_variables);
+  auto sorted_assumptions = sortedCopy(assumptions);
+  auto cached_definition = findCachedDefinition(defined_variable, sorted_defining_variables, sorted_assumptions, false);
+  if (cached_definition) {
+    auto definition = cached_definition->definition;
+    auto definition_circuit = cached_definition->definition_circuit;
+    // The caller adds the definition to its formulas, so the auxiliary variables must not clash with the ones of an earlier copy.
+    renameAuxiliaryVariables(definition, definition_circuit, cached_definition->first_auxiliary_variable, last_used_variable);
+    return std::make_tuple(definition, definition_circuit);
+  }
+  bool minimized = (defined_variable == last_minimized_variable && sorted_assumptions == last_minimized_assumptions);
+  auto first_auxiliary_variable = last_used_variable + 1;
+  auto [definition, definition_circuit] = computeDefinition(defining_variables, defined_variable, assumptions);
+  cacheDefinition(defined_variable, CachedDefinition{std::move(sorted_defining_variables), std::move(sorted_assumptions), minimized,
+      definition, definition_circuit, first_auxiliary_variable});
+  return std::make_tuple(definition, definition_circuit);
+}
+
+const DefinabilityChecker::CachedDefinition* DefinabilityChecker::findCachedDefinition(int defined_variable, const std::vector<int>& defining_variables, const std::vector<int>& assumptions, bool minimized) const {
+  auto it = definition_cache.find(defined_variable);
+  if (it == definition_cache.end()) {
+    return nullptr;
+  }
+  for (const auto& entry: it->second) {
+    if ((entry.minimized || !minimized) &&
+        std::includes(defining_variables.begin(), defining_variables.end(), entry.defining_variables.begin(), entry.defining_variables.end()) &&
+        std::includes(assumptions.begin(), assumptions.end(), entry.assumptions.begin(), entry.assumptions.end())) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+bool DefinabilityChecker::isCachedUndefined(int defined_variable, const std::vector<int>& defining_variables, const std::vector<int>& assumptions, int limit) const {
+  auto it = undefined_cache.find(defined_variable);
+  if (it == undefined_cache.end()) {
+    return false;
+  }
+  for (const auto& entry: it->second) {
+    // A check without a conflict limit proved undefinedness, otherwise the query must not have a larger limit.
+    if (entry.clause_epoch == clause_epoch && (entry.limit == -1 || (limit != -1 && limit <= entry.limit)) &&
+        std::includes(entry.defining_variables.begin(), entry.defining_variables.end(), defining_variables.begin(), defining_variables.end()) &&
+        std::includes(entry.assumptions.begin(), entry.assumptions.end(), assumptions.begin(), assumptions.end())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void DefinabilityChecker::cacheDefinition(int defined_variable, CachedDefinition&& entry) {
+  reserveCacheSpace(cachedSize(entry));
+  auto& entries = definition_cache[defined_variable];
+  if (entries.size() == max_entries_per_variable) {
+    definability_cache_size -= cachedSize(entries.front());
+    entries.erase(entries.begin());
+  }
+  entries.push_back(std::move(entry));
+}
+
+void DefinabilityChecker::cacheUndefined(int defined_variable, CachedUndefined&& entry) {
+  reserveCacheSpace(cachedSize(entry));
+  auto& entries = undefined_cache[defined_variable];
+  // Results from earlier epochs can no longer be used.
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [this](const CachedUndefined& cached) {
+    if (cached.clause_epoch == clause_epoch) {
+      return false;
+    }
+    definability_cache_size -= cachedSize(cached);
+    return true;
+  }), entries.end());
+  if (entries.size() == max_entries_per_variable) {
+    definability_cache_size -= cachedSize(entries.front());
+    entries.erase(entries.begin());
+  }
+  entries.push_back(std::move(entry));
+}
+
+size_t DefinabilityChecker::cachedSize(const CachedDefinition& entry) {
+  size_t size = entry.defining_variables.size() + entry.assumptions.size();
+  for (const auto& clause: entry.definition) {
+    size += clause.size();
+  }
+  return size;
+}
+
+size_t DefinabilityChecker::cachedSize(const CachedUndefined& entry) {
+  return entry.defining_variables.size() + entry.assumptions.size();
+}
+
+void DefinabilityChecker::reserveCacheSpace(size_t size) {
+  if (definability_cache_size + size > max_definability_cache_size) {
+    definition_cache.clear();
+    undefined_cache.clear();
+    definability_cache_size = 0;
+  }
+  definability_cache_size += size;
+}
+
+std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::computeDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions) {
   /* auto is_defined = checkDefined(defining_variables, defined_variable, assumptions, -1);
   if (!is_defined) {
     throw std::runtime_error("Definition extraction called when variable is undefined.");
@@ -202,47 +532,220 @@ std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> D
     cdef.push_back(std::make_tuple(std::vector<int>{},forced_definition[0][0]));
     return std::make_tuple(forced_definition, cdef);
   }
+  if (config.definition_engine == DefinitionEngine::CubeEnumeration) {
+    auto [enumerated, definition_clauses, definition_circuit] = enumerateDefinition(defining_variables, defined_variable, assumptions, std::chrono::steady_clock::time_point::max());
+    if (enumerated) {
+      return std::make_tuple(definition_clauses, definition_circuit);
+    }
+    // The enumeration ran into the conflict limit or the cube limit.
+  } else if (config.definition_engine == DefinitionEngine::Race) {
+    return raceDefinition(defining_variables, defined_variable, assumptions);
+  }
+  return interpolateDefinition(defining_variables, defined_variable, assumptions);
+}
+
+/**
+ * Interpolation is retried with a reset solver at most max_interpolation_attempts times, with cube enumeration in between if
+ * it is available. Afterwards cube enumeration is run without a deadline, even if this creates a second copy of the matrix.
+ **/
+std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::interpolateDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions) {
+  for (int attempt = 0; attempt < max_interpolation_attempts; attempt++) {
+    auto [interpolated, definition_clauses, definition_circuit] = tryInterpolation(defining_variables, defined_variable, assumptions);
+    if (interpolated) {
+      return std::make_tuple(definition_clauses, definition_circuit);
+    }
+    // Resetting the interpolating solver replays the whole formula, so cube enumeration gets a chance first.
+    // In the lean encoding this would create a second copy of the matrix, thus the enumeration is only tried if that copy already exists.
+    if (lean && !backbone_solver && !enumeration_solver) {
+      continue;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.definition_race_budget);
+    auto [enumerated, enumerated_clauses, enumerated_circuit] = enumerateDefinition(defining_variables, defined_variable, assumptions, deadline);
+    if (enumerated) {
+      return std::make_tuple(enumerated_clauses, enumerated_circuit);
+    }
+  }
+  auto [enumerated, enumerated_clauses, enumerated_circuit] = enumerateDefinition(defining_variables, defined_variable, assumptions, std::chrono::steady_clock::time_point::max());
+  if (enumerated) {
+    return std::make_tuple(enumerated_clauses, enumerated_circuit);
+  }
+  throw std::runtime_error("Could not extract a definition for variable " + std::to_string(defined_variable) + ".");
+}
+
+/**
+ * Runs cube enumeration in a separate thread while the definition is interpolated and returns the definition with the smaller circuit.
+ * The enumeration only uses its own solver and a fresh activation literal, thus both can run at the same time.
+ **/
+std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::raceDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions) {
+  auto solver = getEnumerationSolver();
+  auto activation_literal = ++last_used_variable;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.definition_race_budget);
+  auto enumeration = std::async(std::launch::async, [&, solver, activation_literal, deadline]() {
+    return enumerateCubes(*solver, defining_variables, defined_variable, assumptions, activation_literal, deadline);
+  });
+  auto [interpolated, definition_clauses, definition_circuit] = tryInterpolation(defining_variables, defined_variable, assumptions);
+  auto [enumerated, cubes] = enumeration.get();
+  solver->addClause(Clause{-activation_literal});
+  if (enumerated) {
+    // Inputs of the AND gates for the cubes and of the gate for their disjunction.
+    size_t enumerated_size = cubes.size();
+    for (const auto& cube: cubes) {
+      enumerated_size += cube.size();
+    }
+    size_t interpolated_size = 0;
+    for (const auto& [inputs, output]: definition_circuit) {
+      interpolated_size += inputs.size();
+    }
+    if (!interpolated || enumerated_size < interpolated_size) {
+      DLOG(trace) << "Cube enumeration wins the race for " << defined_variable << " with " << cubes.size() << " cubes." << std::endl;
+      return definitionFromCubes(cubes, defined_variable);
+    }
+  }
+  if (interpolated) {
+    return std::make_tuple(definition_clauses, definition_circuit);
+  }
+  return interpolateDefinition(defining_variables, defined_variable, assumptions);
+}
+
+/**
+ * Extracts a definition from the proof of the interpolating solver. Errors during the interpolation are reported,
+ * and the solver is reset before the next interpolant is extracted.
+ **/
+std::tuple<bool, std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::tryInterpolation(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions) {
+  if (reset_interpolating_solver) {
+    interpolating_solver->resetSolver();
+    reset_interpolating_solver = false;
+    checkDefinedInterpolate(defining_variables, defined_variable, assumptions, -1);
+  } else if (lean) {
+    // The forced check used the interpolating solver, the definability check has to be repeated to obtain the proof.
+    checkDefinedInterpolate(defining_variables, defined_variable, assumptions, -1);
+  }
   // Call the "slow" interpolating solver and extract the definition from its proof.
-  // bool itp_defined = checkDefinedInterpolate(defining_variables, defined_variable, assumptions, -1);
-  // assert(itp_defined);
   try {
     auto [definition_clauses, definition_circuit] = getDefinitionInterpolant(defining_variables, defined_variable);
     last_used_variable = std::max(last_used_variable, maxVarIndex(definition_clauses));
-    return std::make_tuple(definition_clauses, definition_circuit);
+    return std::make_tuple(true, definition_clauses, definition_circuit);
   }
   catch (const std::invalid_argument&) {
-    // Handle errors occurring during interpolation by resetting the solver and trying again.
     std::cerr << "Invalid arguments during interpolation, resetting solver." << std::endl;
-    interpolating_solver->resetSolver();
-    return getDefinition(defining_variables, defined_variable, assumptions);
   }
   catch (const std::runtime_error&) {
     std::cerr << "BCP error during interpolation, resetting solver." << std::endl;
-    interpolating_solver->resetSolver();
-    checkDefinedInterpolate(defining_variables, defined_variable, assumptions, -1);
-    return getDefinition(defining_variables, defined_variable, assumptions);
   }
+  reset_interpolating_solver = true;
+  return std::make_tuple(false, std::vector<Clause>{}, std::vector<std::tuple<std::vector<int>,int>>{});
+}
+
+std::tuple<bool, std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::enumerateDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, std::chrono::steady_clock::time_point deadline) {
+  auto solver = getEnumerationSolver();
+  auto activation_literal = ++last_used_variable;
+  auto [enumerated, cubes] = enumerateCubes(*solver, defining_variables, defined_variable, assumptions, activation_literal, deadline);
+  solver->addClause(Clause{-activation_literal});
+  if (!enumerated) {
+    return std::make_tuple(false, std::vector<Clause>{}, std::vector<std::tuple<std::vector<int>,int>>{});
+  }
+  auto [definition_clauses, definition_circuit] = definitionFromCubes(cubes, defined_variable);
+  return std::make_tuple(true, definition_clauses, definition_circuit);
+}
+
+/**
+ * Enumerates the on-set of defined_variable over the defining variables. Each model with the defined variable set to true
+ * yields a cube over the defining variables, which is shrunk to the failed assumptions of a check that the variable cannot be false
+ * (which holds since the variable is defined). The cube is blocked by a clause that is activated by activation_literal.
+ * Returns false if a check runs into the conflict limit, there are too many cubes, or the deadline has passed.
+ **/
+std::tuple<bool, std::vector<std::vector<int>>> DefinabilityChecker::enumerateCubes(SatSolver& solver, const std::vector<int>& defining_variables, int defined_variable,
+    const std::vector<int>& assumptions, int activation_literal, std::chrono::steady_clock::time_point deadline) const {
+  std::vector<std::vector<int>> cubes;
+  auto limit = config.conflict_limit_definability_checker;
+  while (cubes.size() < max_definition_cubes && std::chrono::steady_clock::now() < deadline) {
+    solver.assume(assumptions);
+    solver.assume({ activation_literal, defined_variable });
+    auto result = solver.solve(limit);
+    if (result == 20) {
+      return std::make_tuple(true, cubes);
+    } else if (result != 10) {
+      break;
+    }
+    auto cube = solver.getValues(defining_variables);
+    solver.assume(assumptions);
+    solver.assume(cube);
+    solver.assume({ -defined_variable });
+    if (solver.solve(limit) != 20) {
+      break;
+    }
+    cube = solver.getFailed(cube);
+    Clause blocking_clause;
+    for (auto l: cube) {
+      blocking_clause.push_back(-l);
+    }
+    blocking_clause.push_back(-activation_literal);
+    solver.addClause(blocking_clause);
+    cubes.push_back(cube);
+  }
+  return std::make_tuple(false, std::vector<std::vector<int>>{});
+}
+
+/**
+ * The definition is the disjunction of the cubes, encoded by an AND gate for each cube and the gate -defined_variable = AND(-g_1,...,-g_n).
+ **/
+std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> DefinabilityChecker::definitionFromCubes(const std::vector<std::vector<int>>& cubes, int defined_variable) {
+  std::vector<std::tuple<std::vector<int>,int>> definition_circuit;
+  if (cubes.size() == 1) {
+    definition_circuit.emplace_back(cubes.front(), defined_variable);
+  } else {
+    std::vector<int> negated_cube_outputs;
+    for (const auto& cube: cubes) {
+      if (cube.size() == 1) {
+        negated_cube_outputs.push_back(-cube.front());
+      } else {
+        auto cube_output = ++last_used_variable;
+        definition_circuit.emplace_back(cube, cube_output);
+        negated_cube_outputs.push_back(-cube_output);
+      }
+    }
+    definition_circuit.emplace_back(negated_cube_outputs, -defined_variable);
+  }
+  std::vector<Clause> definition_clauses;
+  for (const auto& gate: definition_circuit) {
+    auto gate_clauses = clausalEncodingAND(gate);
+    definition_clauses.insert(definition_clauses.end(), gate_clauses.begin(), gate_clauses.end());
+  }
+  return std::make_tuple(definition_clauses, definition_circuit);
+}
+
+/**
+ * The backbone solver contains the matrix and the added clauses, in the lean encoding a separate solver is created on first use.
+ * That solver holds a full copy of the matrix, thus combining the lean encoding with cube enumeration or a race gives up its memory savings.
+ **/
+std::shared_ptr<SatSolver> DefinabilityChecker::getEnumerationSolver() {
+  if (backbone_solver) {
+    return backbone_solver;
+  }
+  if (!enumeration_solver) {
+    enumeration_solver = giveSolverInstance(config.definability_solver);
+    enumeration_solver->appendFormula(matrix);
+    enumeration_solver->appendFormula(added_clauses);
+  }
+  return enumeration_solver;
 }
 
 bool DefinabilityChecker::checkDefined(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int limit) {
+  if (lean) {
+    return checkDefinedInterpolate(defining_variables, defined_variable, assumptions, limit);
+  }
   auto renamed_assumptions = renameClause(assumptions, renaming);
   fast_solver->assume(assumptions);
   fast_solver->assume(renamed_assumptions);
   std::vector<int> eq_selector_and_defined_assumptions;
-  std::unordered_set<int> assumption_variables;
-  for (auto l: assumptions) {
-    assumption_variables.insert(var(l));
-  }
-  for (auto& variable: defining_variables) {
-    if (assumption_variables.find(variable) == assumption_variables.end()) {
-      try {
-        eq_selector_and_defined_assumptions.push_back(variable_to_equality_selector.at(variable));
-      }
-      catch (const std::out_of_range&) {}
-    }
+  if (nested_query) {
+    eq_selector_and_defined_assumptions.push_back(nested_selector);
+  } else {
+    addEqualitySelectors(defining_variables, assumptions, eq_selector_and_defined_assumptions);
   }
-  eq_selector_and_defined_assumptions.push_back(variable_to_on_selector[defined_variable]);
-  eq_selector_and_defined_assumptions.push_back(variable_to_off_selector[defined_variable]);
+  auto [on_selector, off_selector] = getOnOffSelectors(defined_variable);
+  eq_selector_and_defined_assumptions.push_back(on_selector);
+  eq_selector_and_defined_assumptions.push_back(off_selector);
   fast_solver->assume(eq_selector_and_defined_assumptions);
 
   if (limit > -1) {
@@ -255,20 +758,14 @@ bool DefinabilityChecker::checkDefined(const std::vector<int>& defining_variable
 bool DefinabilityChecker::checkDefinedInterpolate(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int limit) {
   auto renamed_assumptions = renameClause(assumptions, renaming);
   std::vector<int> eq_selector_and_defined_assumptions;
-  std::unordered_set<int> assumption_variables;
-  for (auto l: assumptions) {
-    assumption_variables.insert(var(l));
-  }
-  for (auto& variable: defining_variables) {
-    if (assumption_variables.find(variable) == assumption_variables.end()) {
-      try {
-        eq_selector_and_defined_assumptions.push_back(variable_to_equality_selector.at(variable));
-      }
-      catch (const std::out_of_range&) {}
-    }
+  if (nested_query) {
+    eq_selector_and_defined_assumptions.push_back(nested_selector);
+  } else {
+    addEqualitySelectors(defining_variables, assumptions, eq_selector_and_defined_assumptions);
   }
-  eq_selector_and_defined_assumptions.push_back(variable_to_on_selector[defined_variable]);
-  eq_selector_and_defined_assumptions.push_back(variable_to_off_selector[defined_variable]);
+  auto [on_selector, off_selector] = getOnOffSelectors(defined_variable);
+  eq_selector_and_defined_assumptions.push_back(on_selector);
+  eq_selector_and_defined_assumptions.push_back(off_selector);
 
   std::vector<int> assumptions_all = assumptions;
   assumptions_all.insert(assumptions_all.end(), renamed_assumptions.begin(), renamed_assumptions.end());
@@ -278,6 +775,10 @@ bool DefinabilityChecker::checkDefinedInterpolate(const std::vector<int>& defini
 }
 
 std::vector<int> DefinabilityChecker::getFailed(const std::vector<int>& assumptions) {
+  if (lean) {
+    std::vector<int> failed_assumptions = assumptions;
+    return getConflict(failed_assumptions);
+  }
   auto renamed_assumptions = renameClause(assumptions, renaming);
   auto failed_assumptions = fast_solver->getFailed(assumptions);
   auto failed_renamed_assumptions = fast_solver->getFailed(renamed_assumptions);
@@ -1,46 +1,153 @@
 #ifndef PEDANT_DEFINABILITYCHECKER_H_
 #define PEDANT_DEFINABILITYCHECKER_H_
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <tuple>
 
 #include "solvertypes.h"
-#include <memory>
+#include "clausedatabase.h"
 #include "satsolver.h"
 #include "ITPsolver.h"
 #include "configuration.h"
+#include "utils.h"
 
 namespace pedant {
 
 class DefinabilityChecker {
 
  public:
-  DefinabilityChecker(std::vector<int>& universal_variables, const std::vector<int>& existential_variables, std::vector<Clause>& matrix, int& last_used_variable, const Configuration& config, bool compress=false);
+  DefinabilityChecker(const std::vector<int>& universal_variables, const std::vector<int>& existential_variables, const ClauseDatabase& matrix, int& last_used_variable, const Configuration& config, bool compress=false);
   DefinabilityChecker(DefinabilityChecker&& checker, int& last_used_variable, const Configuration& config);	
+  /**
+   * Creates an independent checker for the same formula (including the clauses added with addClause) that can be used
+   * concurrently with checker. Auxiliary variables of the replica are numbered from last_used_variable + 1 on.
+   **/
+  DefinabilityChecker(const DefinabilityChecker& checker, int& last_used_variable);
+  /**
+   * If config.definability_cache is set, proven definitions and undefinedness results are remembered per variable.
+   * A definition w.r.t. defining variables D under assumptions A answers every query with a superset of D and A.
+   * An undefinedness result answers queries with subsets of D and A and at most the same conflict limit, as long as no clause has been added.
+   **/
   std::tuple<bool, std::vector<int>> checkDefinability(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int limit, bool minimize_assumptions=false);
   std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> getDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions);
+  /**
+   * Nested checks, where the defining variables of each check are those of the previous check plus some more (as for the innermost existentials).
+   * The equalities of the defining variables are switched on by a chain of prefix selectors, each implying the previous one,
+   * so a check assumes a single selector instead of one per defining variable, and the assumptions share their prefix.
+   * startNestedChecks sets the initial defining variables, addNestedDefiningVariable extends them.
+   * The results of nested checks are not cached.
+   **/
+  void startNestedChecks(const std::vector<int>& defining_variables);
+  void addNestedDefiningVariable(int variable);
+  std::tuple<bool, std::vector<int>> checkDefinabilityNested(int defined_variable, const std::vector<int>& assumptions, int limit);
+  std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> getDefinitionNested(int defined_variable, const std::vector<int>& assumptions);
+  void endNestedChecks();
   void addVariable(int variable, bool shared=true);
   void addClause(Clause& clause);
   int getMaxVariable() const;
 
  private:
   std::tuple<bool, std::vector<Clause>, std::vector<int>> checkForced(int variable, const std::vector<int>& assumptions);
+  std::tuple<bool, std::vector<Clause>, std::vector<int>> checkForcedInterpolating(int variable, const std::vector<int>& assumptions);
+  std::tuple<int, int> getOnOffSelectors(int variable);
+  int getEqualitySelector(int variable);
+  void addEqualitySelectors(const std::vector<int>& defining_variables, const std::vector<int>& assumptions, std::vector<int>& selectors);
+  // Prefix selectors only occur in the second part, like the equality selectors they imply.
+  void addPrefixSelectorClause(Clause& clause);
   std::vector<int> getConflict(std::vector<int>& assumptions);
   std::tuple<std::vector<Clause>,std::vector<std::tuple<std::vector<int>,int>>> getDefinitionInterpolant(const std::vector<int>& defining_variables, int defined_variable);
   bool checkDefinedInterpolate(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int limit);
   bool checkDefined(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int limit);
   std::vector<int> getFailed(const std::vector<int>& assumptions);
+  std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> computeDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions);
+  std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> interpolateDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions);
+  std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> raceDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions);
+  std::tuple<bool, std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> tryInterpolation(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions);
+  std::tuple<bool, std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> enumerateDefinition(const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, std::chrono::steady_clock::time_point deadline);
+  std::tuple<bool, std::vector<std::vector<int>>> enumerateCubes(SatSolver& solver, const std::vector<int>& defining_variables, int defined_variable, const std::vector<int>& assumptions, int activation_literal, std::chrono::steady_clock::time_point deadline) const;
+  std::tuple<std::vector<Clause>, std::vector<std::tuple<std::vector<int>,int>>> definitionFromCubes(const std::vector<std::vector<int>>& cubes, int defined_variable);
+  std::shared_ptr<SatSolver> getEnumerationSolver();
+
+  struct CachedDefinition {
+    // Sorted.
+    std::vector<int> defining_variables;
+    std::vector<int> assumptions;
+    // The assumptions have been minimized by checkDefinability.
+    bool minimized;
+    std::vector<Clause> definition;
+    std::vector<std::tuple<std::vector<int>,int>> definition_circuit;
+    // Variables from here on are auxiliary variables of the definition and are renamed whenever it is reused.
+    int first_auxiliary_variable;
+  };
+  struct CachedUndefined {
+    // Sorted.
+    std::vector<int> defining_variables;
+    std::vector<int> assumptions;
+    // Conflict limit of the check, -1 if there was none.
+    int limit;
+    size_t clause_epoch;
+  };
+  const CachedDefinition* findCachedDefinition(int defined_variable, const std::vector<int>& defining_variables, const std::vector<int>& assumptions, bool minimized) const;
+  bool isCachedUndefined(int defined_variable, const std::vector<int>& defining_variables, const std::vector<int>& assumptions, int limit) const;
+  void cacheDefinition(int defined_variable, CachedDefinition&& entry);
+  void cacheUndefined(int defined_variable, CachedUndefined&& entry);
+  static size_t cachedSize(const CachedDefinition& entry);
+  static size_t cachedSize(const CachedUndefined& entry);
+  void reserveCacheSpace(size_t size);
 
+  std::vector<int> universal_variables, existential_variables;
+  const ClauseDatabase& matrix;
+  ClauseDatabase added_clauses;
   int& last_used_variable;
   bool compress;
+  // The lean encoding keeps the matrix only once (in the interpolating solver) and introduces selectors on demand.
+  bool lean;
   std::unordered_map<int, int> renaming, renaming_inverse;
   std::unordered_map<int, int> variable_to_equality_selector;
   std::unordered_map<int, int> variable_to_on_selector;
   std::unordered_map<int, int> variable_to_off_selector;
+
+  struct EqualitySelectors {
+    std::vector<int> variables;
+    std::vector<int> selectors;
+  };
+  std::unordered_map<std::vector<int>, EqualitySelectors, IntVectorHasher> equality_selector_cache;
+  // Defining variables and the current prefix selector of the nested checks.
+  std::vector<int> nested_defining_variables;
+  int nested_selector = 0;
+  // Set during a nested check, the equality selectors are then replaced by the prefix selector.
+  bool nested_query = false;
+  size_t equality_selector_cache_size = 0;
+  // Bound on the keys, variables and selectors in equality_selector_cache (2^24 ints, 64 MiB), the cache is cleared when it is exceeded.
+  // A dropped entry only costs a few new selector clauses, thus the bound is kept small.
+  static constexpr size_t max_equality_selector_cache_size = size_t(1) << 24;
+
+  std::unordered_map<int, std::vector<CachedDefinition>> definition_cache;
+  std::unordered_map<int, std::vector<CachedUndefined>> undefined_cache;
+  // Incremented by addClause, undefinedness results from earlier epochs are void.
+  size_t clause_epoch = 0;
+  size_t definability_cache_size = 0;
+  // Bound on the defining variables, assumptions and definition literals in both result caches (2^24 ints, 64 MiB).
+  // The same order as the selector cache, since after clearing both caches the checks are simply repeated.
+  static constexpr size_t max_definability_cache_size = size_t(1) << 24;
+  // Number of definitions and undefinedness results kept per variable, the oldest one is replaced.
+  static constexpr size_t max_entries_per_variable = 8;
+  // The failed assumptions of the last successful check with minimize_assumptions set.
+  int last_minimized_variable = 0;
+  std::vector<int> last_minimized_assumptions;
   std::shared_ptr<SatSolver> backbone_solver, fast_solver;
+  // Holds the matrix for cube enumeration, the backbone solver is used instead if there is one.
+  std::shared_ptr<SatSolver> enumeration_solver;
+  // Cube enumeration gives up (and interpolation takes over) if the on-set needs more cubes than this.
+  static constexpr size_t max_definition_cubes = 1024;
   std::shared_ptr<ITPSolver> interpolating_solver;
+  // Set after a failed interpolation, the solver is reset before the next interpolant is extracted.
+  bool reset_interpolating_solver = false;
+  // A failure after a reset usually repeats, so a few attempts suffice before cube enumeration is forced.
+  static constexpr int max_interpolation_attempts = 3;
   const Configuration& config;
 
 };
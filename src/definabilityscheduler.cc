@@ -0,0 +1,59 @@
+#include "definabilityscheduler.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace pedant {
+
+DefinabilityScheduler::DefinabilityScheduler(int base_conflict_limit) : base_conflict_limit(std::max(1, base_conflict_limit)) {
+}
+
+void DefinabilityScheduler::push(int variable, const VariableInfo& info) {
+  queue.emplace(info.failures, info.nof_defining_variables, -static_cast<long>(info.nof_occurrences), variable);
+}
+
+void DefinabilityScheduler::add(int variable, size_t nof_defining_variables, size_t nof_occurrences) {
+  auto& info = variable_info[variable];
+  info.nof_defining_variables = nof_defining_variables;
+  info.nof_occurrences = nof_occurrences;
+  if (info.scheduled || info.failures >= max_attempts) {
+    return;
+  }
+  info.scheduled = true;
+  push(variable, info);
+}
+
+std::tuple<int, int> DefinabilityScheduler::next() {
+  auto variable = std::get<3>(queue.top());
+  queue.pop();
+  auto& info = variable_info[variable];
+  info.scheduled = false;
+  if (info.failures == 0) {
+    return std::make_tuple(variable, 1);
+  }
+  // Each retry doubles the limit. A retry with a limit that is not larger would only be answered by the cache of the definability checker.
+  // The probe used limit 1.
+  long limit = std::max(2, base_conflict_limit);
+  for (size_t i = 1; i < info.failures && limit < INT_MAX - 1; i++) {
+    limit *= 2;
+  }
+  return std::make_tuple(variable, static_cast<int>(std::min<long>(limit, INT_MAX - 1)));
+}
+
+void DefinabilityScheduler::failed(int variable) {
+  auto& info = variable_info[variable];
+  info.failures++;
+  if (!info.scheduled && info.failures < max_attempts) {
+    info.scheduled = true;
+    push(variable, info);
+  }
+}
+
+void DefinabilityScheduler::forgetFailures(int variable) {
+  auto it = variable_info.find(variable);
+  if (it != variable_info.end()) {
+    it->second.failures = 0;
+  }
+}
+
+}
@@ -0,0 +1,78 @@
+#ifndef PEDANT_DEFINABILITYSCHEDULER_H_
+#define PEDANT_DEFINABILITYSCHEDULER_H_
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace pedant {
+
+/**
+ * Decides which variable is checked for definability next and with which conflict limit.
+ * Variables are ordered by their estimated payoff: variables with fewer failed checks come first,
+ * then variables with fewer defining variables (cheaper checks), then variables with more occurrences in the matrix.
+ * The first check of a variable is a probe with conflict limit 1. Afterwards the limit starts at the base limit and
+ * doubles with each failed check, thus every retry is a new query and not answered by the cache of the definability checker.
+ * After max_attempts failed checks a variable is only scheduled again if its failures are forgotten.
+ **/
+class DefinabilityScheduler {
+
+ public:
+  DefinabilityScheduler(int base_conflict_limit);
+  /**
+   * Schedules variable unless it is already scheduled or has used up its attempts.
+   **/
+  void add(int variable, size_t nof_defining_variables, size_t nof_occurrences);
+  /**
+   * Removes the variable with the highest payoff and returns it together with the conflict limit for its check.
+   * Must not be called if the scheduler is empty.
+   **/
+  std::tuple<int, int> next();
+  /**
+   * The check of variable failed. The variable is scheduled again unless it has used up its attempts.
+   **/
+  void failed(int variable);
+  /**
+   * The formula has changed in a way that may make variable definable, it gets all its attempts back.
+   **/
+  void forgetFailures(int variable);
+  bool empty() const;
+  size_t size() const;
+
+  static constexpr size_t max_attempts = 8;
+
+ private:
+  // (failures, defining variables, -occurrences, variable), the smallest entry is checked first.
+  using Entry = std::tuple<size_t, size_t, long, int>;
+
+  struct VariableInfo {
+    size_t failures = 0;
+    size_t nof_defining_variables = 0;
+    size_t nof_occurrences = 0;
+    bool scheduled = false;
+  };
+
+  void push(int variable, const VariableInfo& info);
+
+  int base_conflict_limit;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  std::unordered_map<int, VariableInfo> variable_info;
+
+};
+
+// Implementations
+
+inline bool DefinabilityScheduler::empty() const {
+  return queue.empty();
+}
+
+inline size_t DefinabilityScheduler::size() const {
+  return queue.size();
+}
+
+}
+
+#endif // PEDANT_DEFINABILITYSCHEDULER_H_
@@ -0,0 +1,99 @@
+#include "definabilityworker.h"
+
+#include <tuple>
+#include <utility>
+
+#include "utils.h"
+#include "logging.h"
+
+namespace pedant {
+
+DefinabilityWorker::DefinabilityWorker(const DefinabilityChecker& checker, int last_used_variable, const Configuration& config) :
+    config(config), last_shared_variable(last_used_variable), last_used_variable(last_used_variable) {
+  // The replica is created by the main thread, since checker must not be modified concurrently.
+  this->checker = std::make_unique<DefinabilityChecker>(checker, this->last_used_variable);
+  thread = std::thread(&DefinabilityWorker::run, this);
+}
+
+DefinabilityWorker::~DefinabilityWorker() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex);
+    stop = true;
+    wake_up = true;
+  }
+  wake_condition.notify_one();
+  thread.join();
+}
+
+void DefinabilityWorker::addClause(const Clause& clause) {
+  clauses.push(clause);
+}
+
+void DefinabilityWorker::check(int variable, std::vector<int> defining_variables) {
+  tasks.push(Task{variable, std::move(defining_variables)});
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex);
+    wake_up = true;
+  }
+  wake_condition.notify_one();
+}
+
+bool DefinabilityWorker::pollResult(Result& result) {
+  return results.pop(result);
+}
+
+void DefinabilityWorker::addClauseToReplica(Clause& clause) {
+  for (auto& l: clause) {
+    auto v = var(l);
+    if (v > last_shared_variable) {
+      auto it = variable_map.find(v);
+      if (it == variable_map.end()) {
+        it = variable_map.emplace(v, ++last_used_variable).first;
+      }
+      l = l > 0 ? it->second : -it->second;
+    }
+  }
+  checker->addClause(clause);
+}
+
+/**
+ * Tasks are collected before the clauses, thus a clause that was added before a task is known to the replica when the task is processed.
+ * A variable that is scheduled again before it was checked is only checked once.
+ * Without pending tasks the worker waits for check, the clauses added in the meantime are processed with the next task.
+ **/
+void DefinabilityWorker::run() {
+  std::map<int, std::vector<int>> pending;
+  Task task;
+  Clause clause;
+  std::vector<int> no_assumptions;
+  while (!stop.load(std::memory_order_relaxed)) {
+    while (tasks.pop(task)) {
+      pending[task.variable] = std::move(task.defining_variables);
+    }
+    while (clauses.pop(clause)) {
+      addClauseToReplica(clause);
+    }
+    if (pending.empty()) {
+      std::unique_lock<std::mutex> lock(wake_mutex);
+      wake_condition.wait(lock, [this]() { return wake_up; });
+      wake_up = false;
+      continue;
+    }
+    auto it = pending.begin();
+    auto variable = it->first;
+    auto defining_variables = std::move(it->second);
+    pending.erase(it);
+    nof_checks.fetch_add(1, std::memory_order_relaxed);
+    auto [defined, conflict] = checker->checkDefinability(defining_variables, variable, no_assumptions, config.conflict_limit_definability_checker + 1);
+    if (defined) {
+      Result result;
+      result.variable = variable;
+      result.first_auxiliary_variable = last_shared_variable + 1;
+      std::tie(result.definition, result.definition_circuit) = checker->getDefinition(defining_variables, variable, conflict);
+      DLOG(trace) << "Background definition found for variable " << variable << "." << std::endl;
+      results.push(std::move(result));
+    }
+  }
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef PEDANT_DEFINABILITYWORKER_H_
+#define PEDANT_DEFINABILITYWORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "solvertypes.h"
+#include "configuration.h"
+#include "definabilitychecker.h"
+#include "parallel.h"
+
+namespace pedant {
+
+/**
+ * Searches for definitions in a background thread while the CEGIS loop runs.
+ * The worker owns a replica of the definability checker. The main thread forwards the clauses it adds to its own checker
+ * and the variables to check, the worker publishes the definitions it finds. The data goes through lock-free queues,
+ * an idle worker sleeps on a condition variable until it gets a new task.
+ * The main thread still waits for the worker in two places: ABC keeps global state, thus an interpolation of the worker
+ * blocks interpolations and circuit minimizations of the main thread (see abcMutex), and the destructor joins the thread.
+ *
+ * Variables introduced by the main thread after the replica was created are mapped to fresh variables of the replica.
+ * Definitions are unconditional and only contain defining variables and auxiliary variables of the replica, the latter
+ * have to be renamed with renameAuxiliaryVariables starting at first_auxiliary_variable.
+ **/
+class DefinabilityWorker {
+
+ public:
+  struct Result {
+    int variable = 0;
+    std::vector<Clause> definition;
+    Circuit definition_circuit;
+    int first_auxiliary_variable = 0;
+  };
+
+  DefinabilityWorker(const DefinabilityChecker& checker, int last_used_variable, const Configuration& config);
+  ~DefinabilityWorker();
+  DefinabilityWorker(const DefinabilityWorker&) = delete;
+  DefinabilityWorker& operator=(const DefinabilityWorker&) = delete;
+
+  // The following methods must only be called from the thread that created the worker.
+  void addClause(const Clause& clause);
+  void check(int variable, std::vector<int> defining_variables);
+  bool pollResult(Result& result);
+  size_t getNofChecks() const;
+
+ private:
+  struct Task {
+    int variable = 0;
+    std::vector<int> defining_variables;
+  };
+
+  void run();
+  void addClauseToReplica(Clause& clause);
+
+  const Configuration& config;
+  // Variables up to this one are shared with the main thread.
+  int last_shared_variable;
+  int last_used_variable;
+  std::unique_ptr<DefinabilityChecker> checker;
+  std::unordered_map<int, int> variable_map;
+
+  SpscQueue<Clause> clauses;
+  SpscQueue<Task> tasks;
+  SpscQueue<Result> results;
+  std::atomic<bool> stop{false};
+  // Set by check and the destructor, wakes the idle worker. Guarded by wake_mutex.
+  bool wake_up = false;
+  std::mutex wake_mutex;
+  std::condition_variable wake_condition;
+  std::atomic<size_t> nof_checks{0};
+  std::thread thread;
+
+};
+
+// Implementations
+
+inline size_t DefinabilityWorker::getNofChecks() const {
+  return nof_checks.load(std::memory_order_relaxed);
+}
+
+}
+
+#endif // PEDANT_DEFINABILITYWORKER_H_
@@ -1,6 +1,11 @@
 #include <cassert>
 #include <algorithm>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PEDANT_BITSET_X86
+#include <immintrin.h>
+#endif
+
 #include "dependencycontainer.h"
 #include "utils.h"
 
@@ -69,101 +74,101 @@ std::vector<int> BaseDependencyContainer::restrictToVector(const std::vector<int
 // DependencyContainer_Vector
 
 DependencyContainer_Vector::DependencyContainer_Vector( const Configuration& config, std::unordered_map<int, std::vector<int>>&& dependencies, 
-                                                        std::unordered_map<int, std::vector<int>>&& extended_dependencies,
+                                                        ExtendedDependencies&& extended_dependencies,
                                                         const std::set<int>& undefined_variables, const std::unordered_set<int>& universal_variables,
                                                         const std::vector<int>& ordered_universals) :
                                                         BaseDependencyContainer(config, std::move(dependencies), universal_variables, ordered_universals),
                                                         extended_dependencies_map(std::move(extended_dependencies)), undefined_variables(undefined_variables) {
-  for (auto& [var, deps] : extended_dependencies_map) {
-    std::sort(deps.begin(), deps.end());
-  }
 }
 
 void DependencyContainer_Vector::updateExtendedDependencies(int variable, const std::set<int>& support_set, std::set<int>& updated_variables) {
   extended_dependencies_to_compute.insert(variable);
-  supports.emplace(variable, std::vector<int>(support_set.begin(), support_set.end()));
+  setSupport(variable, support_set);
   extended_dependencies_map.erase(variable);
-  for (const auto& var : undefined_variables) {
-    auto& deps = extended_dependencies_map.at(var);
-    if (std::includes(deps.begin(), deps.end(), support_set.begin(), support_set.end())) {
+  for (auto var : getUpdateCandidates(support_set)) {
+    if (extended_dependencies_map.includes(var, support_set.begin(), support_set.end())) {
       updated_variables.insert(var);
       std::vector<int> x {variable};
-      updateVectorMap(var, x);
+      addToExtendedDependencies(var, x);
     }
   }
 }
 
 void DependencyContainer_Vector::setExtendedDependencies(int var, const std::vector<int>& deps) {
-  extended_dependencies_map.emplace(var, deps);
+  if (!extended_dependencies_map.has(var)) {
+    extended_dependencies_map.set(var, deps);
+    invalidateDynamicDependencies(var);
+  }
 }
 
 void DependencyContainer_Vector::setExtendedDependencies(int var, const std::set<int>& dependencies) {
-  extended_dependencies_map.emplace(var, std::vector<int>(dependencies.begin(), dependencies.end()));
+  if (!extended_dependencies_map.has(var)) {
+    extended_dependencies_map.set(var, dependencies);
+    invalidateDynamicDependencies(var);
+  }
 }
 
 void DependencyContainer_Vector::scheduleUpdate(int variable, const std::set<int>& support_set, std::set<int>& updated_variables) {
   extended_dependencies_to_compute.insert(variable);
-  supports.emplace(variable, std::vector<int>(support_set.begin(), support_set.end()));
+  setSupport(variable, support_set);
   variables_to_update.erase(variable);
   extended_dependencies_map.erase(variable);
-  for (const auto& var : undefined_variables) {
-    // auto& deps = extended_dependencies_map.at(var);
+  for (auto var : getUpdateCandidates(support_set)) {
     if (includedInDependencies(var, support_set)) {
       updated_variables.insert(var);
       variables_to_update[var].push_back(variable);
+      scheduled_occurrences[variable].push_back(var);
     }
   }
 }
 
 void DependencyContainer_Vector::performUpdate() {
   for (auto& [key, val] : variables_to_update) {
-    updateVectorMap(key, val);
+    addToExtendedDependencies(key, val);
   }
   variables_to_update.clear();
+  scheduled_occurrences.clear();
 }
 
 bool DependencyContainer_Vector::includedInExtendedDependencies(int var, const std::vector<int>& variables) const {
   if (extended_dependencies_to_compute.find(var) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(var);
+    const auto& deps = getDynamicDependencies(var);
     return std::includes(deps.begin(), deps.end(), variables.begin(), variables.end());
   } else {
-    auto& deps = extended_dependencies_map.at(var);
-    return std::includes(deps.begin(), deps.end(), variables.begin(), variables.end());
+    return extended_dependencies_map.includes(var, variables.begin(), variables.end());
   }
 }
 
 bool DependencyContainer_Vector::includedInExtendedDependencies(int var, const std::set<int>& variables) const {
   if (extended_dependencies_to_compute.find(var) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(var);
+    const auto& deps = getDynamicDependencies(var);
     return std::includes(deps.begin(), deps.end(), variables.begin(), variables.end());
   } else {
-    auto& deps = extended_dependencies_map.at(var);
-    return std::includes(deps.begin(), deps.end(), variables.begin(), variables.end());
+    return extended_dependencies_map.includes(var, variables.begin(), variables.end());
   } 
 }
 
 bool DependencyContainer_Vector::containedInExtendedDependencies(int var1, int var2) const {
   if (extended_dependencies_to_compute.find(var2) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(var2);
-    return deps.find(var1) != deps.end();
-  } else {
-    auto& deps = extended_dependencies_map.at(var2);
+    const auto& deps = getDynamicDependencies(var2);
     return std::binary_search(deps.begin(), deps.end(), var1);
+  } else {
+    return extended_dependencies_map.contains(var2, var1);
   } 
 }
 
 bool DependencyContainer_Vector::largerExtendedDependencies(int var1, int var2) const {
   int size1, size2;
   if (extended_dependencies_to_compute.find(var1) != extended_dependencies_to_compute.end()) {
-    size1 = computeDynamicDependencies(var1).size();
+    size1 = getDynamicDependencies(var1).size();
   } else {
-    size1 = extended_dependencies_map.at(var1).size();
+    size1 = extended_dependencies_map.size(var1);
   }
 
   if (extended_dependencies_to_compute.find(var2) != extended_dependencies_to_compute.end()) {
-    size2 = computeDynamicDependencies(var2).size();
+    size2 = getDynamicDependencies(var2).size();
   } else {
-    size2 = extended_dependencies_map.at(var2).size();
+    size2 = extended_dependencies_map.size(var2);
   }
 
   return size1 > size2;
@@ -175,11 +180,9 @@ std::vector<int> DependencyContainer_Vector::restrictToExtendedDendenciesSorted(
   }
 
   if (extended_dependencies_to_compute.find(var) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(var);
-    return restrictTo(literals, deps); 
+    return restrictToSortedVector(literals, getDynamicDependencies(var));
   } else {
-    const auto& deps = extended_dependencies_map.at(var);
-    return restrictToVector(literals, deps); 
+    return extended_dependencies_map.restrict(literals, var);
   }
 }
 
@@ -188,27 +191,17 @@ std::vector<int> DependencyContainer_Vector::restrictToExtendedDendencies(const
     return {};
   }
   if (extended_dependencies_to_compute.find(variable) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(variable);
-    return restrictTo(literals, deps); 
+    return restrictToSortedVector(literals, getDynamicDependencies(variable));
   } else {
-    const auto& deps = extended_dependencies_map.at(variable);
-    std::vector<int> literals_range;
-    for (const auto& l: literals) {
-      auto v = var(l);
-      if (std::binary_search(deps.begin(), deps.end(), v)) {
-        literals_range.push_back(l);
-      }
-    }
-    return literals_range;
+    return extended_dependencies_map.restrict(literals, variable);
   }
 }
 
 std::vector<int> DependencyContainer_Vector::getExtendedDependencies(int var) const {
   if (extended_dependencies_to_compute.find(var) != extended_dependencies_to_compute.end()) {
-    auto deps = computeDynamicDependencies(var);
-    return std::vector<int> (deps.begin(), deps.end());
+    return getDynamicDependencies(var);
   } else {
-    return extended_dependencies_map.at(var);
+    return extended_dependencies_map.get(var);
   }
 }
 
@@ -223,95 +216,387 @@ std::vector<int> DependencyContainer_Vector::getExistentialDependencies(int var)
   return result;
 }
 
-std::set<int> DependencyContainer_Vector::computeDynamicDependencies(int var) const {
-  auto support = supports.at(var);
-  std::set<int> result(support.begin(), support.end());
+const std::vector<int>& DependencyContainer_Vector::getDynamicDependencies(int var) const {
+  auto it = dynamic_dependencies.find(var);
+  if (it != dynamic_dependencies.end()) {
+    return it->second;
+  }
+  if (dynamic_dependencies_size > max_dynamic_dependencies_size) {
+    dynamic_dependencies.clear();
+    dynamic_dependencies_size = 0;
+  }
+  // Compute the dynamic dependencies of the variables in the supports first (post-order), so that the
+  // dependencies of each variable are computed only once.
+  std::vector<std::pair<int, bool>> stack {{var, false}};
+  while (!stack.empty()) {
+    auto [v, supports_done] = stack.back();
+    stack.pop_back();
+    if (dynamic_dependencies.find(v) != dynamic_dependencies.end()) {
+      continue;
+    }
+    if (supports_done) {
+      auto deps = computeDynamicDependencies(v);
+      dynamic_dependencies_size += deps.size();
+      dynamic_dependencies.emplace(v, std::move(deps));
+    } else {
+      stack.emplace_back(v, true);
+      for (auto s : supports.at(v)) {
+        if (extended_dependencies_to_compute.find(s) != extended_dependencies_to_compute.end() && dynamic_dependencies.find(s) == dynamic_dependencies.end()) {
+          stack.emplace_back(s, false);
+        }
+      }
+    }
+  }
+  return dynamic_dependencies.at(var);
+}
+
+/**
+ * Requires that the dynamic dependencies of the variables in the support that are in extended_dependencies_to_compute are cached.
+ **/
+std::vector<int> DependencyContainer_Vector::computeDynamicDependencies(int var) const {
+  const auto& support = supports.at(var);
+  std::vector<int> result(support.begin(), support.end());
   for (auto var : support) {
     if (universal_variables.find(var) != universal_variables.end()) {
-      result.insert(var);
+      continue;
     } else if (extended_dependencies_to_compute.find(var) != extended_dependencies_to_compute.end()) {
-      auto deps = computeDynamicDependencies(var);
-      result.insert(deps.begin(), deps.end());
+      const auto& deps = dynamic_dependencies.at(var);
+      result.insert(result.end(), deps.begin(), deps.end());
     } else {
-      const auto& deps = extended_dependencies_map.at(var);
-      result.insert(deps.begin(), deps.end());
+      const auto deps = extended_dependencies_map.get(var);
+      result.insert(result.end(), deps.begin(), deps.end());
     }
   }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
   return result;
 }
 
-void DependencyContainer_Vector::updateVectorMap(int var, const std::vector<int>& variables_to_include) {
-  auto& deps = extended_dependencies_map.at(var);
-  std::vector<int> new_deps;
-  new_deps.reserve(deps.size() + variables_to_include.size());
+void DependencyContainer_Vector::setSupport(int var, const std::set<int>& support_set) {
+  if (supports.emplace(var, std::vector<int>(support_set.begin(), support_set.end())).second) {
+    for (auto v : support_set) {
+      support_occurrences[v].push_back(var);
+    }
+  }
+  invalidateDynamicDependencies(var);
+}
 
-  int i = 0, j = 0;
-  while(i < deps.size() && j < variables_to_include.size()) {
-    auto& v1 = deps[i];
-    auto& v2 = variables_to_include[j];
-    if (v1 == v2) {
-      new_deps.push_back(v1);
-      i++;
-      j++;
-    } else if (v1 < v2) {
-      new_deps.push_back(v1);
-      i++;
-    } else {
-      new_deps.push_back(v2);
-      j++;
+/**
+ * Removes the cached dynamic dependencies that depend on the extended dependencies of var.
+ * If the dynamic dependencies of a variable are not cached, neither are the dynamic dependencies of the variables that have it in their support.
+ **/
+void DependencyContainer_Vector::invalidateDynamicDependencies(int var) {
+  std::vector<int> stack {var};
+  while (!stack.empty()) {
+    auto v = stack.back();
+    stack.pop_back();
+    auto it = dynamic_dependencies.find(v);
+    if (it != dynamic_dependencies.end()) {
+      dynamic_dependencies_size -= it->second.size();
+      dynamic_dependencies.erase(it);
+    } else if (v != var) {
+      continue;
+    }
+    auto occurrences_it = support_occurrences.find(v);
+    if (occurrences_it != support_occurrences.end()) {
+      stack.insert(stack.end(), occurrences_it->second.begin(), occurrences_it->second.end());
+    }
+  }
+}
+
+void DependencyContainer_Vector::addToExtendedDependencies(int var, const std::vector<int>& variables_to_include) {
+  for (auto v : variables_to_include) {
+    extended_dependencies_map.add(var, v);
+  }
+  invalidateDynamicDependencies(var);
+}
+
+std::vector<int> DependencyContainer_Vector::restrictToSortedVector(const std::vector<int>& literals, const std::vector<int>& range) const {
+  std::vector<int> literals_range;
+  for (const auto& l: literals) {
+    if (std::binary_search(range.begin(), range.end(), var(l))) {
+      literals_range.push_back(l);
     }
   }
-  new_deps.insert(new_deps.end(), deps.begin() + i, deps.end());
-  new_deps.insert(new_deps.end(), variables_to_include.begin() + j, variables_to_include.end());
-  std::swap(deps, new_deps);
+  return literals_range;
 }
 
 bool DependencyContainer_Vector::includedInDependencies(int var, const std::set<int>& support_set) const {
   assert(extended_dependencies_to_compute.find(var) == extended_dependencies_to_compute.end());
-  const auto& deps = extended_dependencies_map.at(var);
-  if (variables_to_update.find(var) == variables_to_update.end()) {
-    return std::includes(deps.begin(), deps.end(), support_set.begin(), support_set.end());
+  auto update_it = variables_to_update.find(var);
+  for (auto v : support_set) {
+    if (!extended_dependencies_map.contains(var, v) &&
+        (update_it == variables_to_update.end() || std::find(update_it->second.begin(), update_it->second.end(), v) == update_it->second.end())) {
+      return false;
+    }
   }
+  return true;
+}
+
+std::vector<int> DependencyContainer_Vector::getUpdateCandidates(const std::set<int>& support_set) {
+  std::vector<int> candidates;
+  // Find the variable of the support set that is contained in the fewest extended dependencies.
+  extended_dependencies_map.indexOccurrences();
+  auto nof_candidates = undefined_variables.size();
+  int rarest_variable = 0;
+  for (auto v : support_set) {
+    auto nof_occurrences = extended_dependencies_map.nofOccurrences(v);
+    auto scheduled_it = scheduled_occurrences.find(v);
+    if (scheduled_it != scheduled_occurrences.end()) {
+      nof_occurrences += scheduled_it->second.size();
+    }
+    if (nof_occurrences < nof_candidates) {
+      nof_candidates = nof_occurrences;
+      rarest_variable = v;
+    }
+  }
+  if (rarest_variable == 0) {
+    // No variable is selective enough (or the support set is empty), thus all undefined variables are candidates.
+    candidates.assign(undefined_variables.begin(), undefined_variables.end());
+    return candidates;
+  }
+  auto add_candidate = [this, &candidates](int var) {
+    if (isUndefined(var)) {
+      candidates.push_back(var);
+    }
+  };
+  extended_dependencies_map.forEachOccurrence(rarest_variable, add_candidate);
+  auto scheduled_it = scheduled_occurrences.find(rarest_variable);
+  if (scheduled_it != scheduled_occurrences.end()) {
+    std::for_each(scheduled_it->second.begin(), scheduled_it->second.end(), add_candidate);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return candidates;
+}
 
-  auto dep1_it = deps.begin();
-  auto dep1_last = deps.end();
-  auto dep2_it = variables_to_update.at(var).begin();
-  auto dep2_last = variables_to_update.at(var).end();
+bool DependencyContainer_Vector::isUndefined(int var) const {
+  return undefined_variables.find(var) != undefined_variables.end();
+}
+
+size_t DependencyContainer_Vector::getNofUndefined() const {
+  return undefined_variables.size();
+}
 
 
-  auto supp_it = support_set.begin();
-  auto supp_last = support_set.end();
+// DependencyContainer_Bitset
 
-  while (supp_it != supp_last) {
-    if (dep1_it == dep1_last) {
-      return std::includes(dep2_it, dep2_last, supp_it, supp_last);
-    } 
-    if (dep2_it == dep2_last) {
-      return std::includes(dep1_it, dep1_last, supp_it, supp_last);
+namespace {
+
+/**
+ * Checks whether every bit set in a[0],...,a[n-1] is also set in b[0],...,b[n-1].
+ **/
+bool isSubsetScalar(const uint64_t* a, const uint64_t* b, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] & ~b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef PEDANT_BITSET_X86
+
+bool isSubsetSSE2(const uint64_t* a, const uint64_t* b, size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_andnot_si128(vb, va), zero)) != 0xFFFF) {
+      return false;
     }
-    if (*supp_it < *dep1_it && *supp_it < *dep2_it) {
+  }
+  return isSubsetScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+bool isSubsetAVX2(const uint64_t* a, const uint64_t* b, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    // The carry flag is set iff (~vb & va) == 0.
+    if (!_mm256_testc_si256(vb, va)) {
       return false;
     }
-    if (*supp_it == *dep1_it || *supp_it == *dep2_it) {
-      supp_it++;
+  }
+  return isSubsetScalar(a + i, b + i, n - i);
+}
+
+#endif
+
+bool isSubset(const uint64_t* a, const uint64_t* b, size_t n) {
+#ifdef PEDANT_BITSET_X86
+  static const bool avx2_supported = __builtin_cpu_supports("avx2");
+  return avx2_supported ? isSubsetAVX2(a, b, n) : isSubsetSSE2(a, b, n);
+#else
+  return isSubsetScalar(a, b, n);
+#endif
+}
+
+}
+
+DependencyContainer_Bitset::DependencyContainer_Bitset( const Configuration& config, std::unordered_map<int, std::vector<int>>&& dependencies, 
+                                                        ExtendedDependencies&& extended_dependencies,
+                                                        const std::set<int>& undefined_variables, const std::unordered_set<int>& universal_variables,
+                                                        const std::vector<int>& ordered_universals) :
+                                                        DependencyContainer_Vector(config, std::move(dependencies), std::move(extended_dependencies),
+                                                        undefined_variables, universal_variables, ordered_universals) {
+  auto nof_variables = extended_dependencies_map.nofVariables();
+  if (!config.dependency_bitsets || nof_variables == 0) {
+    return;
+  }
+  nof_bits = extended_dependencies_map.maxVariable() + 1;
+  for (auto u : universal_variables) {
+    nof_bits = std::max(nof_bits, static_cast<size_t>(u) + 1);
+  }
+  nof_words = (nof_bits + 63) / 64;
+  double density = static_cast<double>(extended_dependencies_map.totalSize()) / (static_cast<double>(nof_variables) * nof_bits);
+  bitset_budget = std::min(max_bitset_words, static_cast<size_t>(bitset_words_per_dependency * extended_dependencies_map.totalSize()));
+  use_bitsets = nof_variables * nof_words <= bitset_budget && density >= min_bitset_density;
+}
+
+void DependencyContainer_Bitset::updateExtendedDependencies(int variable, const std::set<int>& support_set, std::set<int>& updated_variables) {
+  bitsets.erase(variable);
+  DependencyContainer_Vector::updateExtendedDependencies(variable, support_set, updated_variables);
+}
+
+void DependencyContainer_Bitset::scheduleUpdate(int variable, const std::set<int>& support_set, std::set<int>& updated_variables) {
+  if (!use_bitsets) {
+    DependencyContainer_Vector::scheduleUpdate(variable, support_set, updated_variables);
+    return;
+  }
+  extended_dependencies_to_compute.insert(variable);
+  setSupport(variable, support_set);
+  variables_to_update.erase(variable);
+  extended_dependencies_map.erase(variable);
+  bitsets.erase(variable);
+
+  // Only the words between the first and the last variable of the support have to be compared.
+  query.clear();
+  query_out_of_range.clear();
+  size_t first_word = nof_words, last_word = 0;
+  for (auto v : support_set) {
+    if (inRange(v)) {
+      first_word = std::min(first_word, static_cast<size_t>(v >> 6));
+      last_word = std::max(last_word, static_cast<size_t>(v >> 6));
+    } else {
+      query_out_of_range.push_back(v);
     }
-    if (*dep1_it < *supp_it) {
-      dep1_it++;
+  }
+  query_first_word = first_word;
+  if (first_word <= last_word) {
+    query.assign(last_word - first_word + 1, 0);
+    for (auto v : support_set) {
+      if (inRange(v)) {
+        query[(v >> 6) - first_word] |= uint64_t(1) << (v & 63);
+      }
     }
-    if (*dep2_it < *supp_it) {
-      dep2_it++;
+  }
+
+  for (auto var : getUpdateCandidates(support_set)) {
+    if (includedInDependencies(var)) {
+      updated_variables.insert(var);
+      variables_to_update[var].push_back(variable);
+      scheduled_occurrences[variable].push_back(var);
     }
   }
-  return true;
 }
 
-bool DependencyContainer_Vector::isUndefined(int var) const {
-  return undefined_variables.find(var) != undefined_variables.end();
+void DependencyContainer_Bitset::setExtendedDependencies(int var, const std::vector<int>& dependencies) {
+  bitsets.erase(var);
+  DependencyContainer_Vector::setExtendedDependencies(var, dependencies);
 }
 
-size_t DependencyContainer_Vector::getNofUndefined() const {
-  return undefined_variables.size();
+void DependencyContainer_Bitset::setExtendedDependencies(int var, const std::set<int>& dependencies) {
+  bitsets.erase(var);
+  DependencyContainer_Vector::setExtendedDependencies(var, dependencies);
+}
+
+bool DependencyContainer_Bitset::includedInExtendedDependencies(int var, const std::vector<int>& variables) const {
+  if (hasBitset(var)) {
+    return includedInBitset(var, variables.begin(), variables.end());
+  }
+  return DependencyContainer_Vector::includedInExtendedDependencies(var, variables);
+}
+
+bool DependencyContainer_Bitset::includedInExtendedDependencies(int var, const std::set<int>& variables) const {
+  if (hasBitset(var)) {
+    return includedInBitset(var, variables.begin(), variables.end());
+  }
+  return DependencyContainer_Vector::includedInExtendedDependencies(var, variables);
+}
+
+bool DependencyContainer_Bitset::containedInExtendedDependencies(int var1, int var2) const {
+  if (hasBitset(var2) && inRange(var1)) {
+    const auto& bits = getBitset(var2);
+    return (bits[var1 >> 6] >> (var1 & 63)) & 1;
+  }
+  return DependencyContainer_Vector::containedInExtendedDependencies(var1, var2);
+}
+
+void DependencyContainer_Bitset::addToExtendedDependencies(int var, const std::vector<int>& variables_to_include) {
+  DependencyContainer_Vector::addToExtendedDependencies(var, variables_to_include);
+  auto it = bitsets.find(var);
+  if (it != bitsets.end()) {
+    for (auto v : variables_to_include) {
+      if (inRange(v)) {
+        it->second[v >> 6] |= uint64_t(1) << (v & 63);
+      }
+    }
+  }
+}
+
+const std::vector<uint64_t>& DependencyContainer_Bitset::getBitset(int var) const {
+  auto it = bitsets.find(var);
+  if (it != bitsets.end()) {
+    return it->second;
+  }
+  // Variables whose extended dependencies are set later on are not accounted for in the initial estimate.
+  if ((bitsets.size() + 1) * nof_words > bitset_budget) {
+    bitsets.clear();
+  }
+  std::vector<uint64_t> bits(nof_words, 0);
+  for (auto v : extended_dependencies_map.get(var)) {
+    if (inRange(v)) {
+      bits[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+  }
+  return bitsets.emplace(var, std::move(bits)).first->second;
 }
 
+/**
+ * Checks whether the support set of the current call of scheduleUpdate is included in the extended dependencies of var,
+ * taking into account the updates that have been scheduled but not performed yet.
+ **/
+bool DependencyContainer_Bitset::includedInDependencies(int var) const {
+  assert(extended_dependencies_to_compute.find(var) == extended_dependencies_to_compute.end());
+  const auto& bits = getBitset(var);
+  const uint64_t* bits_in_range = bits.data() + query_first_word;
+  auto update_it = variables_to_update.find(var);
+  auto scheduled = [&update_it, this](int v) {
+    return update_it != variables_to_update.end() && std::find(update_it->second.begin(), update_it->second.end(), v) != update_it->second.end();
+  };
+  if (!isSubset(query.data(), bits_in_range, query.size())) {
+    if (update_it == variables_to_update.end()) {
+      return false;
+    }
+    for (size_t i = 0; i < query.size(); i++) {
+      auto missing = query[i] & ~bits_in_range[i];
+      for (size_t bit = 0; missing; bit++, missing >>= 1) {
+        if ((missing & 1) && !scheduled(static_cast<int>(((query_first_word + i) << 6) + bit))) {
+          return false;
+        }
+      }
+    }
+  }
+  for (auto v : query_out_of_range) {
+    if (!extended_dependencies_map.contains(var, v) && !scheduled(v)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-}
\ No newline at end of file
+}
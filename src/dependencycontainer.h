@@ -1,19 +1,22 @@
 #ifndef DEPENDENCY_CONTAINER_H_
 #define DEPENDENCY_CONTAINER_H_
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <unordered_set>
 #include <set>
 
 #include "configuration.h"
+#include "extendeddependencies.h"
 
 namespace pedant {
 
 
 class DependencyContainer_Vector;
+class DependencyContainer_Bitset;
 
-using DependencyContainer = DependencyContainer_Vector;
+using DependencyContainer = DependencyContainer_Bitset;
 
 class BaseDependencyContainer {
 
@@ -48,18 +51,19 @@ class DependencyContainer_Vector : public BaseDependencyContainer {
 
  public:
   DependencyContainer_Vector(const Configuration& config, std::unordered_map<int, std::vector<int>>&& dependencies, 
-                    std::unordered_map<int, std::vector<int>>&& extended_dependencies,
+                    ExtendedDependencies&& extended_dependencies,
                     const std::set<int>& undefined_variables, const std::unordered_set<int>& universal_variables,
                     const std::vector<int>& ordered_universals);
+  virtual ~DependencyContainer_Vector() = default;
 
-  void updateExtendedDependencies(int var, const std::set<int>& support_set, std::set<int>& updated_variables);   
-  void scheduleUpdate(int var, const std::set<int>& support_set, std::set<int>& updated_variables);      
+  virtual void updateExtendedDependencies(int var, const std::set<int>& support_set, std::set<int>& updated_variables);
+  virtual void scheduleUpdate(int var, const std::set<int>& support_set, std::set<int>& updated_variables);
   void performUpdate(); 
-  void setExtendedDependencies(int var, const std::vector<int>& dependencies);
-  void setExtendedDependencies(int var, const std::set<int>& dependencies);
-  bool includedInExtendedDependencies(int var, const std::vector<int>& variables) const;
-  bool includedInExtendedDependencies(int var, const std::set<int>& variables) const;
-  bool containedInExtendedDependencies(int var1, int var2) const;
+  virtual void setExtendedDependencies(int var, const std::vector<int>& dependencies);
+  virtual void setExtendedDependencies(int var, const std::set<int>& dependencies);
+  virtual bool includedInExtendedDependencies(int var, const std::vector<int>& variables) const;
+  virtual bool includedInExtendedDependencies(int var, const std::set<int>& variables) const;
+  virtual bool containedInExtendedDependencies(int var1, int var2) const;
   bool largerExtendedDependencies(int var1, int var2) const;
   std::vector<int> getExtendedDependencies(int var) const;
   std::vector<int> getExistentialDependencies(int var) const;
@@ -69,20 +73,125 @@ class DependencyContainer_Vector : public BaseDependencyContainer {
   bool isUndefined(int var) const;
   size_t getNofUndefined() const;
 
- private:
-  std::set<int> computeDynamicDependencies(int var) const;
-  void updateVectorMap(int var, const std::vector<int>& variables_to_include);
+ protected:
+  /**
+   * Sorted dynamic dependencies of a variable in extended_dependencies_to_compute. The dependencies are computed on demand
+   * and kept until the extended dependencies of a variable in the support change. The returned reference is valid until the next call.
+   **/
+  const std::vector<int>& getDynamicDependencies(int var) const;
+  std::vector<int> computeDynamicDependencies(int var) const;
+  void setSupport(int var, const std::set<int>& support_set);
+  void invalidateDynamicDependencies(int var);
+  virtual void addToExtendedDependencies(int var, const std::vector<int>& variables_to_include);
   bool includedInDependencies(int var, const std::set<int>& support_set) const;
+  /**
+   * Undefined variables whose extended dependencies may include support_set (including the scheduled updates), sorted.
+   * The candidates are the undefined variables whose extended dependencies contain the variable of the support set with the fewest occurrences.
+   **/
+  std::vector<int> getUpdateCandidates(const std::set<int>& support_set);
+  std::vector<int> restrictToSortedVector(const std::vector<int>& literals, const std::vector<int>& range) const;
 
   std::unordered_set<int> extended_dependencies_to_compute;
   std::unordered_map<int, std::vector<int>> supports;
+  // For each variable the variables in extended_dependencies_to_compute that have it in their support.
+  std::unordered_map<int, std::vector<int>> support_occurrences;
   std::unordered_map<int, std::vector<int>> variables_to_update;
+  // For each variable the variables in variables_to_update that it is scheduled to be added to.
+  std::unordered_map<int, std::vector<int>> scheduled_occurrences;
+
+  mutable std::unordered_map<int, std::vector<int>> dynamic_dependencies;
+  mutable size_t dynamic_dependencies_size = 0;
+  // Bound on the variables in dynamic_dependencies (2^26 ints, 256 MiB). A single entry may hold nearly all variables and
+  // recomputing it walks the whole chain of supports, thus the bound is larger than for the caches of DefinabilityChecker.
+  static constexpr size_t max_dynamic_dependencies_size = size_t(1) << 26;
 
-  std::unordered_map<int, std::vector<int>> extended_dependencies_map;
+  ExtendedDependencies extended_dependencies_map;
   const std::set<int>& undefined_variables;
 
 };
 
+// DependencyContainer_Bitset
+
+/**
+ * Keeps the extended dependencies of the variables from the prefix as dense bitsets (one bit per variable) in addition to the
+ * representation of DependencyContainer_Vector. The bitsets are built on demand and used for the inclusion tests in scheduleUpdate,
+ * which compare one support set against the extended dependencies of all undefined variables, and for containment tests.
+ * Whether bitsets are used is decided once from the number of variables and the density of the extended dependencies,
+ * otherwise all calls are passed to DependencyContainer_Vector.
+ **/
+class DependencyContainer_Bitset : public DependencyContainer_Vector {
+
+ public:
+  DependencyContainer_Bitset(const Configuration& config, std::unordered_map<int, std::vector<int>>&& dependencies, 
+                    ExtendedDependencies&& extended_dependencies,
+                    const std::set<int>& undefined_variables, const std::unordered_set<int>& universal_variables,
+                    const std::vector<int>& ordered_universals);
+
+  void updateExtendedDependencies(int var, const std::set<int>& support_set, std::set<int>& updated_variables) override;
+  void scheduleUpdate(int var, const std::set<int>& support_set, std::set<int>& updated_variables) override;
+  void setExtendedDependencies(int var, const std::vector<int>& dependencies) override;
+  void setExtendedDependencies(int var, const std::set<int>& dependencies) override;
+  bool includedInExtendedDependencies(int var, const std::vector<int>& variables) const override;
+  bool includedInExtendedDependencies(int var, const std::set<int>& variables) const override;
+  bool containedInExtendedDependencies(int var1, int var2) const override;
+
+  bool usesBitsets() const;
+
+ private:
+  void addToExtendedDependencies(int var, const std::vector<int>& variables_to_include) override;
+  const std::vector<uint64_t>& getBitset(int var) const;
+  bool includedInDependencies(int var) const;
+  bool hasBitset(int var) const;
+  bool inRange(int variable) const;
+  template<class InputIt> bool includedInBitset(int var, InputIt first, InputIt last) const;
+
+  // Bitsets pay off if the extended dependencies contain at least this fraction of all variables on average.
+  static constexpr double min_bitset_density = 1.0 / 64;
+  // Absolute upper bound for the memory of the bitsets of all variables in 64-bit words.
+  static constexpr size_t max_bitset_words = size_t(1) << 25;
+  // Number of 64-bit words the bitsets may use per element of the extended dependencies, i.e. the memory of one int.
+  static constexpr double bitset_words_per_dependency = 0.5;
+
+  bool use_bitsets = false;
+  // Bit v represents variable v. Variables outside of the range are handled by DependencyContainer_Vector.
+  size_t nof_bits = 0;
+  size_t nof_words = 0;
+  // Upper bound for the memory of the bitsets in 64-bit words, relative to the size of the extended dependencies.
+  size_t bitset_budget = 0;
+  mutable std::unordered_map<int, std::vector<uint64_t>> bitsets;
+
+  // Bitset of the support set of the current call of scheduleUpdate, restricted to the nonzero words.
+  std::vector<uint64_t> query;
+  size_t query_first_word = 0;
+  std::vector<int> query_out_of_range;
+
+};
+
+// Implementations
+
+inline bool DependencyContainer_Bitset::usesBitsets() const {
+  return use_bitsets;
+}
+
+inline bool DependencyContainer_Bitset::inRange(int variable) const {
+  return variable >= 0 && static_cast<size_t>(variable) < nof_bits;
+}
+
+inline bool DependencyContainer_Bitset::hasBitset(int var) const {
+  return use_bitsets && extended_dependencies_to_compute.find(var) == extended_dependencies_to_compute.end() && extended_dependencies_map.has(var);
+}
+
+template<class InputIt> bool DependencyContainer_Bitset::includedInBitset(int var, InputIt first, InputIt last) const {
+  const auto& bits = getBitset(var);
+  for (; first != last; ++first) {
+    auto v = *first;
+    if (inRange(v) ? !((bits[v >> 6] >> (v & 63)) & 1) : !extended_dependencies_map.contains(var, v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 }
 
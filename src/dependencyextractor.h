@@ -9,6 +9,7 @@
 #include "configuration.h"
 
 #include "dqdimacs.h"
+#include "extendeddependencies.h"
 
 namespace pedant {
 
@@ -21,40 +22,32 @@ class DependencyExtractor {
   DependencyExtractor(DQDIMACS& formula, const Configuration& config);
 
   std::unordered_map<int, std::vector<int>> getDependencies();
-  std::pair<std::unordered_map<int, std::vector<int>>, std::unordered_map<int, std::vector<int>>> getExtendedDependencies();
+  std::pair<std::unordered_map<int, std::vector<int>>, ExtendedDependencies> getExtendedDependencies();
 
 
  private:
   //set original dependencies
   void computeDependencies();
-  std::unordered_map<int, std::vector<int>> computeExtendedDependencies();
+  ExtendedDependencies computeExtendedDependencies();
 
-  //add var to the extended dependencies of all suitable variables with implicit dependencies
-  //add all suitable variables with implicit dependencies to the extendeddependencies of var 
-  void checkImplicitdependencies(int var, std::unordered_map<int, std::vector<int>>& extended_dependencies);
+  //determine the existentials without explicit dependencies in the extended dependencies of var
+  //and the existentials without explicit dependencies that have var in their extended dependencies
+  void checkImplicitdependencies(int var, ExtendedDependencies& extended_dependencies);
 
   int getMaximalSubSet(int var, int start_index, int end_index);
   int getMinimalSuperSet(int var, int start_index, int end_index);
 
-  //add a variable with explicit dependencies to the extended dependencies of variables with implicit dependencies
-  void addExplicitToImplicit(int var, int idx, std::unordered_map<int, std::vector<int>>& extended_dependencies);
-
-  //add variables with implicit dependencies to the extended dependencies of a variable with explicit dependencies
-  void addImplicitToExplicit(int var, int idx, std::unordered_map<int, std::vector<int>>& extended_dependencies);
-
-  void checkExplicitDependencies(int var, const std::vector<int>& processed, std::unordered_map<int, std::vector<int>>& extended_dependencies);
+  void checkExplicitDependencies(int var, const std::vector<int>& processed, ExtendedDependencies& extended_dependencies);
 
   /**
-   * If there are many variables in the range 1 to max_var that are unused in the matrix this has a negative impact on the memory requirements of this method
+   * The path search is performed by an RRSEngine, see rrsengine.h.
    **/
   std::unordered_map<int, std::vector<int>> applyDependencyScheme() const;
 
 
   std::unordered_map<int, std::vector<int>> computeInverseDependencies() const;
-  std::unordered_map<int,std::vector<int>> getContainingClauses() const;
-  void searchPaths(int literal_to_start,std::vector<bool>& toConsider,std::vector<bool>& marked,  std::unordered_map<int, std::vector<int>>& containing_clauses) const;
-  void setUpSearchVectors(int universal, std::vector<bool>& to_consider, std::vector<bool>& marked_positive,std::vector<bool>& marked_negative, const std::vector<int>& inverse_deps) const;
-  void revertSearchVectors(int universal, std::vector<bool>& to_consider, const std::vector<int>& inverse_deps) const;
+  //existentials of the ignored innermost block, resolution paths may pass through them
+  std::vector<int> getIgnoredExistentials() const;
 
   const int max_variable_in_matrix;
   int existential_block_idx_end;
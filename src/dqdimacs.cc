@@ -17,7 +17,7 @@ DQDIMACS::DQDIMACS(int max_var) : max_var(max_var), check_max_var(false) {
 
 
 void DQDIMACS::addClause(const std::vector<int>& clause) {
-  matrix.push_back(clause);
+  matrix.addClause(clause);
 }
 
 void DQDIMACS::addUniversalBlock(const std::vector<int>& variables) {
@@ -112,7 +112,7 @@ int DQDIMACS::getNofExistentialBlocks() const {
   return existential_blocks.size() - 1;
 }
 
-std::vector<std::vector<int>>& DQDIMACS::getMatrix() {
+ClauseDatabase& DQDIMACS::getMatrix() {
   return matrix;
 }
 
@@ -7,6 +7,8 @@
 #include <exception>
 #include <string>
 
+#include "clausedatabase.h"
+
 namespace pedant {
 
 class DQDIMACS {
@@ -29,7 +31,7 @@ class DQDIMACS {
   int getNofUniversalBlocks() const;
   int getNofExistentialBlocks() const;
 
-  std::vector<std::vector<int>>& getMatrix();
+  ClauseDatabase& getMatrix();
   std::vector<int>& getUniversals();
   /**
    * Get the existentials with implicit dependencies.
@@ -51,7 +53,7 @@ class DQDIMACS {
  private:
   int max_var;
   bool check_max_var;
-  std::vector<std::vector<int>> matrix;
+  ClauseDatabase matrix;
   bool first_block_type; //true: universal block, false: existential block
   std::vector<int> universal_variables;
   std::vector<int> universal_blocks;
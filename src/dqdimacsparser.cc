@@ -1,6 +1,7 @@
-#include <sstream>
+#include <limits>
 
 #include "dqdimacsparser.h"
+#include "mappedfile.h"
 
 namespace pedant {
 
@@ -12,127 +13,200 @@ const char * InvalidFileException::what () {
 }
 
 DQDIMACS DQDIMACSParser::parseFormula(const std::string& fname) {
-  std::ifstream input(fname);
-  if (!input) {
+  auto format = inputFormatFromName(fname);
+  if (!isInputFormatSupported(format)) {
+    throw InvalidFileException("The file " + fname + " is " + inputFormatName(format) + " compressed but Pedant was built without support for " + inputFormatName(format) + ".");
+  }
+  if (fname == "-" || format != InputFormat::Plain) {
+    auto source = openInputSource(fname, format);
+    if (!source) {
+      throw InvalidFileException("The file " + fname + " could not be opened.");
+    }
+    return parseStream(*source, fname);
+  }
+  MappedFile input;
+  if (!input.open(fname)) {
     throw InvalidFileException("The file " + fname + " could not be opened.");
   }
+  return parseBuffer(input.data(), input.data() + input.size());
+}
+
+DQDIMACS DQDIMACSParser::parseBuffer(const char* begin, const char* end) {
   DQDIMACS formula;
-  int number_of_variables = processPrefix(input);
-  std::string line;
-  while(std::getline(input,line)) {
-    auto position=line.find_first_not_of(" \t\r\n");
-    if (position==std::string::npos)
-      continue;
-    char first_character=line[position];
-    switch (first_character) {
-      case 'c':
-        continue;
-        break;
-      case 'p':
-        throw InvalidFileException("Only one prefix line is allowed.");
-        break;
-      case 'a':
-        line.erase(0,position+1);
-        parseUniversalBlock(line, formula);
-        break;
-      case 'e':
-        line.erase(0,position+1);
-        parseExistentialBlock(line, formula);
-        break;
-      case 'd':
-        line.erase(0,position+1);
-        parseDependencyBlock(line, formula);
-        break;
-      default:
-        parseClause(line, formula);
-        break;
+  prefix_found = false;
+  const char* position = begin;
+  while (position < end) {
+    const char* line_end = lineEnd(position, end);
+    processLine(position, line_end, formula);
+    position = line_end + 1;
+  }
+  if (!prefix_found) {
+    throw InvalidFileException("The file has to start with a prefix.");
+  }
+  return formula;
+}
+
+DQDIMACS DQDIMACSParser::parseStream(InputSource& source, const std::string& fname) {
+  DQDIMACS formula;
+  prefix_found = false;
+  std::vector<char> buffer(chunk_size);
+  // Number of bytes at the start of the buffer that belong to a line which is not yet complete.
+  size_t pending = 0;
+  while (true) {
+    if (pending == buffer.size()) {
+      buffer.resize(2 * buffer.size());
+    }
+    auto bytes_read = source.read(buffer.data() + pending, buffer.size() - pending);
+    if (bytes_read < 0) {
+      throw InvalidFileException("The file " + fname + " could not be read.");
+    } else if (bytes_read == 0) {
+      break;
     }
-  }  
+    const char* position = buffer.data();
+    const char* end = buffer.data() + pending + bytes_read;
+    const char* line_end;
+    while ((line_end = static_cast<const char*>(memchr(position, '\n', end - position))) != nullptr) {
+      processLine(position, line_end, formula);
+      position = line_end + 1;
+    }
+    pending = end - position;
+    memmove(buffer.data(), position, pending);
+  }
+  if (pending > 0) {
+    processLine(buffer.data(), buffer.data() + pending, formula);
+  }
+  if (!prefix_found) {
+    throw InvalidFileException("The file has to start with a prefix.");
+  }
   return formula;
 }
 
-int DQDIMACSParser::processPrefix(std::istream& input) {
-  std::string line;
-  while(std::getline(input,line)) {
-    auto position=line.find_first_not_of(" \t\r\n");
-    if (position==std::string::npos)
-      continue;
-    char first_character=line[position];
-    switch (first_character) {
+void DQDIMACSParser::processLine(const char* begin, const char* end, DQDIMACS& formula) {
+  const char* first = skipWhitespace(begin, end);
+  if (first == end) {
+    return;
+  }
+  if (!prefix_found) {
+    switch (*first) {
       case 'c':
-        continue;
         break;
       case 'p':
-        line.erase(0,position+1);
-        return parsePrefix(line);
+        parsePrefix(first + 1, end);
+        prefix_found = true;
         break;
       default:
         throw InvalidFileException("The file has to start with a prefix.");
     }
+    return;
+  }
+  switch (*first) {
+    case 'c':
+      break;
+    case 'p':
+      throw InvalidFileException("Only one prefix line is allowed.");
+      break;
+    case 'a':
+      parseUniversalBlock(first + 1, end, formula);
+      break;
+    case 'e':
+      parseExistentialBlock(first + 1, end, formula);
+      break;
+    case 'd':
+      parseDependencyBlock(first + 1, end, formula);
+      break;
+    default:
+      parseClause(begin, end, formula);
+      break;
   }
 }
 
+int DQDIMACSParser::parsePrefix(const char* begin, const char* end) {
+  const char* position = skipWhitespace(begin, end);
+  const char* word_end = position;
+  while (word_end < end && !isWhitespace(*word_end)) {
+    word_end++;
+  }
+  if (word_end - position != 3 || strncmp(position, "cnf", 3) != 0) {
+    throw InvalidFileException("The preamble is invalid.");
+  }
+  position = skipWhitespace(word_end, end);
+  int number_of_variables;
+  if (!parseInteger(position, end, number_of_variables)) {
+    throw InvalidFileException("The preamble is invalid.");
+  }
+  return number_of_variables;
+}
 
-int DQDIMACSParser::parsePrefix(const std::string& line) {
-  std::stringstream str_stream(line);
-  try {
-    std::string str;
-    str_stream >> str;
-    if (str.compare("cnf")!=0) {
-      throw InvalidFileException("The preamble is invalid.");
+bool DQDIMACSParser::parseInteger(const char*& position, const char* end, int& value) const {
+  // Mirrors std::stoi: an optional sign followed by at least one digit, trailing characters of the word are ignored.
+  bool negative = false;
+  if (position < end && (*position == '-' || *position == '+')) {
+    negative = (*position == '-');
+    position++;
+  }
+  if (position == end || *position < '0' || *position > '9') {
+    return false;
+  }
+  long long magnitude = 0;
+  while (position < end && *position >= '0' && *position <= '9') {
+    magnitude = magnitude * 10 + (*position - '0');
+    if (magnitude > static_cast<long long>(std::numeric_limits<int>::max()) + 1) {
+      return false;
     }
-    str_stream >> str;
-    int number_of_variables=std::stoi(str);
-    return number_of_variables;
-  }  catch(std::invalid_argument& e){
-    throw InvalidFileException("The preamble is invalid.");
+    position++;
+  }
+  if (!negative && magnitude > std::numeric_limits<int>::max()) {
+    return false;
   }
+  value = static_cast<int>(negative ? -magnitude : magnitude);
+  while (position < end && !isWhitespace(*position)) {
+    position++;
+  }
+  return true;
 }
 
-std::vector<int> DQDIMACSParser::parseLine(const std::string& line, bool check_is_positive) const {
-  std::stringstream str_stream(line);
-  std::string word;
-  std::vector<int> result;
-  try {
-    while (str_stream >> word) {
-      int i=std::stoi(word);
-      if (i==0) {
-        break;
-      }
-      if (check_is_positive && i<0) {
-        throw InvalidFileException("Invalid line - negative int detected: " + line);
-      }
-      result.push_back(i);
+void DQDIMACSParser::parseLine(const char* begin, const char* end, bool check_is_positive) {
+  literals.clear();
+  const char* position = skipWhitespace(begin, end);
+  while (position < end) {
+    int i;
+    if (!parseInteger(position, end, i)) {
+      throw InvalidFileException("Line could not be parsed: " + std::string(begin, end));
+    }
+    if (i==0) {
+      break;
     }
-  } catch(std::invalid_argument& e) {
-    throw InvalidFileException("Line could not be parsed: " + line);
+    if (check_is_positive && i<0) {
+      throw InvalidFileException("Invalid line - negative int detected: " + std::string(begin, end));
+    }
+    literals.push_back(i);
+    position = skipWhitespace(position, end);
   }
-  return result;
 }
 
-void DQDIMACSParser::parseUniversalBlock(const std::string& line, DQDIMACS& formula) {
-  std::vector<int> vars = parseLine(line, true);
-  formula.addUniversalBlock(vars);
+void DQDIMACSParser::parseUniversalBlock(const char* begin, const char* end, DQDIMACS& formula) {
+  parseLine(begin, end, true);
+  formula.addUniversalBlock(literals);
 }
 
-void DQDIMACSParser::parseExistentialBlock(const std::string& line, DQDIMACS& formula) {
-  std::vector<int> vars = parseLine(line, true);
-  formula.addExistentialBlock(vars);
+void DQDIMACSParser::parseExistentialBlock(const char* begin, const char* end, DQDIMACS& formula) {
+  parseLine(begin, end, true);
+  formula.addExistentialBlock(literals);
 }
 
-void DQDIMACSParser::parseDependencyBlock(const std::string& line, DQDIMACS& formula) {
-  std::vector<int> vars = parseLine(line, true);
-  if (vars.empty()) {
-    throw InvalidFileException("Invalid line - no variable is given: " + line);
+void DQDIMACSParser::parseDependencyBlock(const char* begin, const char* end, DQDIMACS& formula) {
+  parseLine(begin, end, true);
+  if (literals.empty()) {
+    throw InvalidFileException("Invalid line - no variable is given: " + std::string(begin, end));
   }
-  int var = vars[0];
-  vars.erase(vars.begin());
-  formula.addExplicitDependencies(var, vars);
+  int var = literals[0];
+  std::vector<int> dependencies(literals.begin() + 1, literals.end());
+  formula.addExplicitDependencies(var, dependencies);
 }
 
-void DQDIMACSParser::parseClause(const std::string& line, DQDIMACS& formula) {
-  std::vector<int> lits = parseLine(line, false);
-  formula.addClause(lits);
+void DQDIMACSParser::parseClause(const char* begin, const char* end, DQDIMACS& formula) {
+  parseLine(begin, end, false);
+  formula.addClause(literals);
 }
 
-}
\ No newline at end of file
+}
@@ -1,11 +1,13 @@
 #ifndef PEDANT_DQDIMACS_PARSER_H_
 #define PEDANT_DQDIMACS_PARSER_H_
 
+#include <cstring>
 #include <exception>
 #include <string>
 #include <vector>
 
 #include "dqdimacs.h"
+#include "inputsource.h"
 
 namespace pedant {
 
@@ -21,6 +23,11 @@ class InvalidFileException : public std::exception
 
 
 
+/**
+ * Parses DQDIMACS files. Plain files are memory-mapped and scanned in place, compressed files (.gz, .xz, .bz2)
+ * and the standard input ("-") are decompressed and scanned in chunks.
+ * Integers are read by a hand-written scanner into a buffer that is reused across lines.
+ **/
 class DQDIMACSParser {
 
  public:
@@ -28,20 +35,49 @@ class DQDIMACSParser {
 
  private:
 
-  int processPrefix(std::istream& in);
-  int parsePrefix(const std::string& line);
-  void parseUniversalBlock(const std::string& line, DQDIMACS& formula);
-  void parseExistentialBlock(const std::string& line, DQDIMACS& formula);
-  void parseDependencyBlock(const std::string& line, DQDIMACS& formula);
-  void parseClause(const std::string& line, DQDIMACS& formula);
+  DQDIMACS parseBuffer(const char* begin, const char* end);
+  DQDIMACS parseStream(InputSource& source, const std::string& fname);
+  void processLine(const char* begin, const char* end, DQDIMACS& formula);
+  int parsePrefix(const char* begin, const char* end);
+  void parseUniversalBlock(const char* begin, const char* end, DQDIMACS& formula);
+  void parseExistentialBlock(const char* begin, const char* end, DQDIMACS& formula);
+  void parseDependencyBlock(const char* begin, const char* end, DQDIMACS& formula);
+  void parseClause(const char* begin, const char* end, DQDIMACS& formula);
 
-  std::vector<int> parseLine(const std::string& line, bool check_is_positive) const;
+  /**
+   * Reads the integers of the line [begin, end) into "literals", stopping at the first 0.
+   **/
+  void parseLine(const char* begin, const char* end, bool check_is_positive);
+  bool parseInteger(const char*& position, const char* end, int& value) const;
+
+  static const char* lineEnd(const char* position, const char* end);
+  static const char* skipWhitespace(const char* position, const char* end);
+  static bool isWhitespace(char c);
+
+  std::vector<int> literals;
+  bool prefix_found = false;
+
+  static constexpr size_t chunk_size = 1 << 20;
 
 };
 
-  
+inline const char* DQDIMACSParser::lineEnd(const char* position, const char* end) {
+  auto line_end = static_cast<const char*>(memchr(position, '\n', end - position));
+  return line_end == nullptr ? end : line_end;
+}
+
+inline bool DQDIMACSParser::isWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+inline const char* DQDIMACSParser::skipWhitespace(const char* position, const char* end) {
+  while (position < end && isWhitespace(*position)) {
+    position++;
+  }
+  return position;
+}
 
 }
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "extendeddependencies.h"
+
+namespace pedant {
+
+void ExtendedDependencies::setUniversalBlocks(const std::vector<int>& universals, const std::vector<size_t>& block_offsets) {
+  universals_in_block_order = universals;
+  universal_block_offsets = block_offsets;
+  for (size_t block = 0; block + 1 < universal_block_offsets.size(); block++) {
+    for (size_t i = universal_block_offsets[block]; i < universal_block_offsets[block + 1]; i++) {
+      auto u = universals_in_block_order[i];
+      if (static_cast<size_t>(u) >= universal_block.size()) {
+        universal_block.resize(u + 1, none);
+      }
+      universal_block[u] = block;
+    }
+  }
+}
+
+void ExtendedDependencies::setExistentialOrder(const std::vector<int>& existentials) {
+  existential_order = existentials;
+  for (size_t i = 0; i < existential_order.size(); i++) {
+    auto e = existential_order[i];
+    if (static_cast<size_t>(e) >= existential_rank.size()) {
+      existential_rank.resize(e + 1, none);
+    }
+    existential_rank[e] = i;
+  }
+}
+
+void ExtendedDependencies::setExplicitThreshold(int variable, size_t threshold) {
+  if (static_cast<size_t>(variable) >= explicit_threshold.size()) {
+    explicit_threshold.resize(variable + 1, none);
+  }
+  auto old_threshold = explicit_threshold[variable];
+  if (old_threshold != none) {
+    explicit_by_threshold.erase(std::lower_bound(explicit_by_threshold.begin(), explicit_by_threshold.end(), std::make_pair(old_threshold, variable)));
+  }
+  explicit_threshold[variable] = threshold;
+  auto element = std::make_pair(threshold, variable);
+  explicit_by_threshold.insert(std::lower_bound(explicit_by_threshold.begin(), explicit_by_threshold.end(), element), element);
+}
+
+void ExtendedDependencies::updateSize(Entry& entry) const {
+  entry.size = universal_block_offsets[std::min(entry.nof_universal_blocks, universal_block_offsets.size() - 1)] +
+      entry.existential_rank + entry.variables.size();
+}
+
+void ExtendedDependencies::setPrefixVariable(int var, size_t nof_universal_blocks, size_t existential_rank) {
+  auto& entry = entries[var];
+  if (occurrences_indexed) {
+    removeFromOccurrences(var, entry);
+  }
+  entry.nof_universal_blocks = nof_universal_blocks;
+  entry.existential_rank = existential_rank;
+  entry.explicit_thresholds = true;
+  entry.variables.clear();
+  updateSize(entry);
+  if (occurrences_indexed) {
+    indexEntry(var, entry);
+  }
+}
+
+void ExtendedDependencies::setExplicitVariable(int var, const std::vector<int>& dependencies, size_t existential_rank) {
+  auto& entry = entries[var];
+  if (occurrences_indexed) {
+    removeFromOccurrences(var, entry);
+  }
+  entry.nof_universal_blocks = 0;
+  entry.existential_rank = existential_rank;
+  entry.explicit_thresholds = false;
+  entry.variables.clear();
+  for (auto v: dependencies) {
+    if (!containsShared(entry, v)) {
+      entry.variables.push_back(v);
+    }
+  }
+  std::sort(entry.variables.begin(), entry.variables.end());
+  entry.variables.erase(std::unique(entry.variables.begin(), entry.variables.end()), entry.variables.end());
+  updateSize(entry);
+  if (occurrences_indexed) {
+    indexEntry(var, entry);
+  }
+}
+
+void ExtendedDependencies::set(int var, const std::vector<int>& dependencies) {
+  setExplicitVariable(var, dependencies, 0);
+}
+
+void ExtendedDependencies::set(int var, const std::set<int>& dependencies) {
+  setExplicitVariable(var, std::vector<int>(dependencies.begin(), dependencies.end()), 0);
+}
+
+void ExtendedDependencies::add(int var, int dependency) {
+  auto& entry = entries.at(var);
+  if (containsShared(entry, dependency)) {
+    return;
+  }
+  auto it = std::lower_bound(entry.variables.begin(), entry.variables.end(), dependency);
+  if (it == entry.variables.end() || *it != dependency) {
+    entry.variables.insert(it, dependency);
+    entry.size++;
+    if (occurrences_indexed) {
+      list_occurrences[dependency].push_back(var);
+    }
+  }
+}
+
+void ExtendedDependencies::erase(int var) {
+  auto it = entries.find(var);
+  if (it == entries.end()) {
+    return;
+  }
+  if (occurrences_indexed) {
+    removeFromOccurrences(var, it->second);
+  }
+  entries.erase(it);
+}
+
+void ExtendedDependencies::indexOccurrences() {
+  if (occurrences_indexed) {
+    return;
+  }
+  for (const auto& [var, entry]: entries) {
+    for (auto v: entry.variables) {
+      list_occurrences[v].push_back(var);
+    }
+    if (entry.existential_rank > 0) {
+      variables_by_rank.emplace_back(entry.existential_rank, var);
+    }
+    if (entry.explicit_thresholds) {
+      prefix_variables_by_blocks.emplace_back(entry.nof_universal_blocks, var);
+      prefix_variables_by_rank.emplace_back(entry.existential_rank, var);
+    }
+  }
+  std::sort(variables_by_rank.begin(), variables_by_rank.end());
+  std::sort(prefix_variables_by_blocks.begin(), prefix_variables_by_blocks.end());
+  std::sort(prefix_variables_by_rank.begin(), prefix_variables_by_rank.end());
+  occurrences_indexed = true;
+}
+
+/**
+ * Adds the occurrences of a new entry to the index. Stale pairs of a previous entry of var are kept in the sorted vectors,
+ * since removing them would take linear time.
+ **/
+void ExtendedDependencies::indexEntry(int var, const Entry& entry) {
+  auto insert_sorted = [](SortedPairs& pairs, std::pair<size_t, int> element) {
+    auto it = std::lower_bound(pairs.begin(), pairs.end(), element);
+    if (it == pairs.end() || *it != element) {
+      pairs.insert(it, element);
+    }
+  };
+  for (auto v: entry.variables) {
+    list_occurrences[v].push_back(var);
+  }
+  if (entry.existential_rank > 0) {
+    insert_sorted(variables_by_rank, std::make_pair(entry.existential_rank, var));
+  }
+  if (entry.explicit_thresholds) {
+    insert_sorted(prefix_variables_by_blocks, std::make_pair(entry.nof_universal_blocks, var));
+    insert_sorted(prefix_variables_by_rank, std::make_pair(entry.existential_rank, var));
+  }
+}
+
+void ExtendedDependencies::removeFromOccurrences(int var, const Entry& entry) {
+  for (auto v: entry.variables) {
+    auto& occurrences = list_occurrences[v];
+    auto it = std::find(occurrences.begin(), occurrences.end(), var);
+    if (it != occurrences.end()) {
+      *it = occurrences.back();
+      occurrences.pop_back();
+    }
+  }
+}
+
+std::vector<int> ExtendedDependencies::restrict(const std::vector<int>& literals, int var) const {
+  const auto& entry = entries.at(var);
+  std::vector<int> literals_restricted;
+  for (auto l: literals) {
+    auto v = abs(l);
+    if (containsShared(entry, v) || std::binary_search(entry.variables.begin(), entry.variables.end(), v)) {
+      literals_restricted.push_back(l);
+    }
+  }
+  return literals_restricted;
+}
+
+std::vector<int> ExtendedDependencies::get(int var) const {
+  const auto& entry = entries.at(var);
+  std::vector<int> result;
+  result.reserve(entry.size);
+  auto nof_universals = universal_block_offsets[std::min(entry.nof_universal_blocks, universal_block_offsets.size() - 1)];
+  result.insert(result.end(), universals_in_block_order.begin(), universals_in_block_order.begin() + nof_universals);
+  result.insert(result.end(), existential_order.begin(), existential_order.begin() + std::min(entry.existential_rank, existential_order.size()));
+  if (entry.explicit_thresholds) {
+    auto last = explicit_by_threshold.begin() + nofExplicitUpTo(entry.existential_rank);
+    for (auto it = explicit_by_threshold.begin(); it != last; it++) {
+      result.push_back(it->second);
+    }
+  }
+  result.insert(result.end(), entry.variables.begin(), entry.variables.end());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+size_t ExtendedDependencies::totalSize() const {
+  size_t total = 0;
+  for (const auto& [var, entry]: entries) {
+    total += entry.explicit_thresholds ? entry.size + nofExplicitUpTo(entry.existential_rank) : entry.size;
+  }
+  return total;
+}
+
+int ExtendedDependencies::maxVariable() const {
+  int max_variable = static_cast<int>(std::max({universal_block.size(), existential_rank.size(), explicit_threshold.size(), size_t(1)})) - 1;
+  for (const auto& [var, entry]: entries) {
+    max_variable = std::max(max_variable, var);
+    if (!entry.variables.empty()) {
+      max_variable = std::max(max_variable, entry.variables.back());
+    }
+  }
+  return max_variable;
+}
+
+}
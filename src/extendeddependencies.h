@@ -0,0 +1,247 @@
+#ifndef PEDANT_EXTENDED_DEPENDENCIES_H_
+#define PEDANT_EXTENDED_DEPENDENCIES_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace pedant {
+
+/**
+ * Stores the extended dependencies of the existential variables without materializing them.
+ * For variables from the quantifier prefix the extended dependencies consist of
+ * - the universals of the first k universal blocks,
+ * - the existentials whose rank (position in the existential order) is smaller than some bound r,
+ * - the variables with explicit dependencies whose threshold is at most r (only for variables from the prefix),
+ * - a sorted list of further variables.
+ * The first three parts are shared by all variables, thus the memory requirement is linear in the size of the prefix
+ * instead of quadratic in the number of existentials. Variables whose extended dependencies are set explicitly only use the list.
+ * The four parts are kept disjoint.
+ **/
+class ExtendedDependencies {
+
+  friend class SnapshotWriter;
+  friend class SnapshotReader;
+
+ public:
+  /**
+   * The universals of block i are universals[block_offsets[i]],...,universals[block_offsets[i+1]-1].
+   **/
+  void setUniversalBlocks(const std::vector<int>& universals, const std::vector<size_t>& block_offsets);
+  /**
+   * The rank of an existential is its position in existentials.
+   **/
+  void setExistentialOrder(const std::vector<int>& existentials);
+  /**
+   * The variable is contained in the extended dependencies of all variables from the prefix whose rank is at least threshold.
+   * Thresholds have to be set before dependencies are added with add.
+   **/
+  void setExplicitThreshold(int variable, size_t threshold);
+
+  /**
+   * The extended dependencies of var consist of the universals from the first nof_universal_blocks blocks,
+   * the existentials with a rank smaller than existential_rank and the variables with explicit dependencies with a threshold
+   * of at most existential_rank.
+   **/
+  void setPrefixVariable(int var, size_t nof_universal_blocks, size_t existential_rank);
+  /**
+   * The extended dependencies of var consist of the given variables and the existentials with a rank smaller than existential_rank.
+   **/
+  void setExplicitVariable(int var, const std::vector<int>& dependencies, size_t existential_rank);
+  void set(int var, const std::vector<int>& dependencies);
+  void set(int var, const std::set<int>& dependencies);
+  /**
+   * Adds dependency to the extended dependencies of var.
+   **/
+  void add(int var, int dependency);
+  void erase(int var);
+
+  bool has(int var) const;
+  bool contains(int var, int dependency) const;
+  template<class InputIt> bool includes(int var, InputIt first, InputIt last) const;
+  size_t size(int var) const;
+  /**
+   * Returns the literals whose variables are contained in the extended dependencies of var. The order of the literals is preserved.
+   **/
+  std::vector<int> restrict(const std::vector<int>& literals, int var) const;
+  /**
+   * Sorted extended dependencies of var.
+   **/
+  std::vector<int> get(int var) const;
+
+  /**
+   * Builds an index of the variables whose extended dependencies contain a given variable.
+   * Once built, the index is kept up to date by the other methods.
+   **/
+  void indexOccurrences();
+  /**
+   * Upper bound on the number of variables whose extended dependencies contain dependency. Requires the index.
+   **/
+  size_t nofOccurrences(int dependency) const;
+  /**
+   * Calls f(var) for each variable var whose extended dependencies contain dependency. Requires the index.
+   * Variables that have been erased or set again after the index was built may be reported as well, possibly more than once.
+   **/
+  template<class F> void forEachOccurrence(int dependency, F f) const;
+
+  size_t nofVariables() const;
+  // Sum of the sizes of the extended dependencies of all variables.
+  size_t totalSize() const;
+  // Largest variable that occurs in the store, 0 if there is none.
+  int maxVariable() const;
+
+ private:
+  static constexpr size_t none = std::numeric_limits<size_t>::max();
+  using SortedPairs = std::vector<std::pair<size_t, int>>;
+
+  struct Entry {
+    size_t nof_universal_blocks = 0;
+    size_t existential_rank = 0;
+    bool explicit_thresholds = false;
+    std::vector<int> variables; // sorted
+    // Size without the variables with explicit dependencies that are included due to their thresholds.
+    size_t size = 0;
+  };
+
+  size_t universalBlock(int variable) const;
+  size_t existentialRank(int variable) const;
+  size_t explicitThreshold(int variable) const;
+  size_t nofExplicitUpTo(size_t rank) const;
+  bool containsShared(const Entry& entry, int dependency) const;
+  void updateSize(Entry& entry) const;
+  void indexEntry(int var, const Entry& entry);
+  void removeFromOccurrences(int var, const Entry& entry);
+  SortedPairs::const_iterator firstSharedOccurrence(int dependency, SortedPairs::const_iterator& last) const;
+
+  std::vector<int> universals_in_block_order;
+  std::vector<size_t> universal_block_offsets{0};
+  std::vector<int> existential_order;
+
+  // Indexed by variables, none if not applicable.
+  std::vector<size_t> universal_block;
+  std::vector<size_t> existential_rank;
+  std::vector<size_t> explicit_threshold;
+  // Variables with explicit dependencies sorted by their thresholds.
+  std::vector<std::pair<size_t, int>> explicit_by_threshold;
+
+  std::unordered_map<int, Entry> entries;
+
+  // Occurrence index, only maintained after indexOccurrences has been called.
+  bool occurrences_indexed = false;
+  // For each variable the variables that have it in their list of further variables.
+  std::unordered_map<int, std::vector<int>> list_occurrences;
+  // Pairs (existential_rank, var) for the variables with a positive rank, (nof_universal_blocks, var) and
+  // (existential_rank, var) for the variables from the prefix, sorted.
+  SortedPairs variables_by_rank;
+  SortedPairs prefix_variables_by_blocks;
+  SortedPairs prefix_variables_by_rank;
+
+};
+
+// Implementations
+
+inline size_t ExtendedDependencies::universalBlock(int variable) const {
+  return (variable >= 0 && static_cast<size_t>(variable) < universal_block.size()) ? universal_block[variable] : none;
+}
+
+inline size_t ExtendedDependencies::existentialRank(int variable) const {
+  return (variable >= 0 && static_cast<size_t>(variable) < existential_rank.size()) ? existential_rank[variable] : none;
+}
+
+inline size_t ExtendedDependencies::explicitThreshold(int variable) const {
+  return (variable >= 0 && static_cast<size_t>(variable) < explicit_threshold.size()) ? explicit_threshold[variable] : none;
+}
+
+inline bool ExtendedDependencies::containsShared(const Entry& entry, int dependency) const {
+  auto block = universalBlock(dependency);
+  if (block != none) {
+    return block < entry.nof_universal_blocks;
+  }
+  auto rank = existentialRank(dependency);
+  if (rank != none) {
+    return rank < entry.existential_rank;
+  }
+  return entry.explicit_thresholds && explicitThreshold(dependency) <= entry.existential_rank;
+}
+
+inline bool ExtendedDependencies::contains(int var, int dependency) const {
+  const auto& entry = entries.at(var);
+  return containsShared(entry, dependency) || std::binary_search(entry.variables.begin(), entry.variables.end(), dependency);
+}
+
+template<class InputIt> bool ExtendedDependencies::includes(int var, InputIt first, InputIt last) const {
+  const auto& entry = entries.at(var);
+  for (; first != last; ++first) {
+    if (!containsShared(entry, *first) && !std::binary_search(entry.variables.begin(), entry.variables.end(), *first)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool ExtendedDependencies::has(int var) const {
+  return entries.find(var) != entries.end();
+}
+
+inline size_t ExtendedDependencies::nofExplicitUpTo(size_t rank) const {
+  return std::upper_bound(explicit_by_threshold.begin(), explicit_by_threshold.end(), std::make_pair(rank, std::numeric_limits<int>::max())) - explicit_by_threshold.begin();
+}
+
+/**
+ * Sets last to the end of the sorted range of shared occurrences of dependency and returns its beginning.
+ * The range is empty if dependency is not part of the shared dependencies.
+ **/
+inline ExtendedDependencies::SortedPairs::const_iterator ExtendedDependencies::firstSharedOccurrence(int dependency, SortedPairs::const_iterator& last) const {
+  auto block = universalBlock(dependency);
+  if (block != none) {
+    last = prefix_variables_by_blocks.end();
+    return std::upper_bound(prefix_variables_by_blocks.begin(), last, std::make_pair(block, std::numeric_limits<int>::max()));
+  }
+  auto rank = existentialRank(dependency);
+  if (rank != none) {
+    last = variables_by_rank.end();
+    return std::upper_bound(variables_by_rank.begin(), last, std::make_pair(rank, std::numeric_limits<int>::max()));
+  }
+  auto threshold = explicitThreshold(dependency);
+  last = prefix_variables_by_rank.end();
+  if (threshold == none) {
+    return last;
+  }
+  return std::lower_bound(prefix_variables_by_rank.begin(), last, std::make_pair(threshold, std::numeric_limits<int>::min()));
+}
+
+inline size_t ExtendedDependencies::nofOccurrences(int dependency) const {
+  SortedPairs::const_iterator last;
+  auto first = firstSharedOccurrence(dependency, last);
+  auto it = list_occurrences.find(dependency);
+  return (last - first) + (it == list_occurrences.end() ? 0 : it->second.size());
+}
+
+template<class F> void ExtendedDependencies::forEachOccurrence(int dependency, F f) const {
+  SortedPairs::const_iterator last;
+  for (auto it = firstSharedOccurrence(dependency, last); it != last; ++it) {
+    f(it->second);
+  }
+  auto it = list_occurrences.find(dependency);
+  if (it != list_occurrences.end()) {
+    for (auto var: it->second) {
+      f(var);
+    }
+  }
+}
+
+inline size_t ExtendedDependencies::nofVariables() const {
+  return entries.size();
+}
+
+inline size_t ExtendedDependencies::size(int var) const {
+  const auto& entry = entries.at(var);
+  return entry.explicit_thresholds ? entry.size + nofExplicitUpTo(entry.existential_rank) : entry.size;
+}
+
+}
+
+#endif // PEDANT_EXTENDED_DEPENDENCIES_H_
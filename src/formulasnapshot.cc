@@ -0,0 +1,508 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "formulasnapshot.h"
+#include "mappedfile.h"
+
+namespace pedant {
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "Snapshots store offsets as 64 bit integers.");
+
+static const char snapshot_magic[8] = {'P', 'E', 'D', 'A', 'N', 'T', 'S', 'N'};
+
+/**
+ * Hash of a byte sequence that is fed in pieces. Full 64-bit words are mixed at once, the remaining bytes one by one.
+ * Used for the checksum of the source file and for the trailer of the snapshot.
+ **/
+class SnapshotHash {
+
+ public:
+  void update(const char* bytes, size_t size);
+  uint64_t digest() const;
+
+ private:
+  void mixWord(uint64_t word);
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  uint64_t total_size = 0;
+  char pending[8];
+  size_t nof_pending = 0;
+
+};
+
+inline void SnapshotHash::mixWord(uint64_t word) {
+  hash = (hash ^ word) * 0x100000001b3ULL;
+  hash ^= hash >> 29;
+}
+
+void SnapshotHash::update(const char* bytes, size_t size) {
+  total_size += size;
+  while (nof_pending > 0 && nof_pending < 8 && size > 0) {
+    pending[nof_pending++] = *bytes++;
+    size--;
+  }
+  if (nof_pending == 8) {
+    uint64_t word;
+    memcpy(&word, pending, 8);
+    mixWord(word);
+    nof_pending = 0;
+  }
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, 8);
+    mixWord(word);
+  }
+  memcpy(pending + nof_pending, bytes, size);
+  nof_pending += size;
+}
+
+uint64_t SnapshotHash::digest() const {
+  auto result = hash;
+  for (size_t i = 0; i < nof_pending; i++) {
+    result = (result ^ static_cast<unsigned char>(pending[i])) * 0x100000001b3ULL;
+  }
+  return result ^ total_size;
+}
+
+class SnapshotWriter {
+
+ public:
+  SnapshotWriter(std::ostream& out);
+  void writeBytes(const char* bytes, size_t size);
+  template<class T> void writeValue(T value);
+  template<class T> void writeArray(const std::vector<T>& values);
+  void writeDependencies(const std::unordered_map<int, std::vector<int>>& dependencies);
+  void writeExtendedDependencies(const ExtendedDependencies& extended_dependencies);
+  /**
+   * Writes the length and the hash of everything written so far.
+   **/
+  void writeTrailer();
+
+ private:
+  void pad();
+
+  std::ostream& out;
+  size_t position;
+  SnapshotHash hash;
+
+};
+
+SnapshotWriter::SnapshotWriter(std::ostream& out) : out(out), position(0) {
+}
+
+void SnapshotWriter::writeBytes(const char* bytes, size_t size) {
+  out.write(bytes, size);
+  hash.update(bytes, size);
+  position += size;
+}
+
+void SnapshotWriter::writeTrailer() {
+  uint64_t trailer[2] = {position, hash.digest()};
+  out.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+}
+
+template<class T> void SnapshotWriter::writeValue(T value) {
+  writeBytes(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T> void SnapshotWriter::writeArray(const std::vector<T>& values) {
+  writeValue<uint64_t>(values.size());
+  writeBytes(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  pad();
+}
+
+void SnapshotWriter::pad() {
+  static const char zeros[8] = {};
+  size_t padding = (8 - position % 8) % 8;
+  writeBytes(zeros, padding);
+}
+
+void SnapshotWriter::writeDependencies(const std::unordered_map<int, std::vector<int>>& dependencies) {
+  // Write the variables in ascending order so that the snapshot of a formula is always the same file.
+  std::map<int, const std::vector<int>*> sorted_dependencies;
+  for (const auto& [variable, variable_dependencies]: dependencies) {
+    sorted_dependencies[variable] = &variable_dependencies;
+  }
+  std::vector<int> variables;
+  std::vector<size_t> offsets{0};
+  std::vector<int> values;
+  for (const auto& [variable, variable_dependencies]: sorted_dependencies) {
+    variables.push_back(variable);
+    values.insert(values.end(), variable_dependencies->begin(), variable_dependencies->end());
+    offsets.push_back(values.size());
+  }
+  writeArray(variables);
+  writeArray(offsets);
+  writeArray(values);
+}
+
+void SnapshotWriter::writeExtendedDependencies(const ExtendedDependencies& extended_dependencies) {
+  writeArray(extended_dependencies.universals_in_block_order);
+  writeArray(extended_dependencies.universal_block_offsets);
+  writeArray(extended_dependencies.existential_order);
+  std::vector<int> explicit_variables;
+  std::vector<size_t> thresholds;
+  for (const auto& [threshold, variable]: extended_dependencies.explicit_by_threshold) {
+    thresholds.push_back(threshold);
+    explicit_variables.push_back(variable);
+  }
+  writeArray(explicit_variables);
+  writeArray(thresholds);
+
+  std::map<int, const ExtendedDependencies::Entry*> sorted_entries;
+  for (const auto& [variable, entry]: extended_dependencies.entries) {
+    sorted_entries[variable] = &entry;
+  }
+  std::vector<int> variables;
+  std::vector<size_t> nof_universal_blocks;
+  std::vector<size_t> existential_ranks;
+  std::vector<uint8_t> explicit_thresholds;
+  ClauseDatabase entry_variables;
+  for (const auto& [variable, entry]: sorted_entries) {
+    variables.push_back(variable);
+    nof_universal_blocks.push_back(entry->nof_universal_blocks);
+    existential_ranks.push_back(entry->existential_rank);
+    explicit_thresholds.push_back(entry->explicit_thresholds);
+    entry_variables.addClause(entry->variables);
+  }
+  writeArray(variables);
+  writeArray(nof_universal_blocks);
+  writeArray(existential_ranks);
+  writeArray(explicit_thresholds);
+  writeArray(entry_variables.getLiterals());
+  writeArray(entry_variables.getOffsets());
+}
+
+class SnapshotReader {
+
+ public:
+  SnapshotReader(const char* data, size_t size);
+  bool skip(size_t bytes);
+  template<class T> bool readValue(T& value);
+  template<class T> bool readArray(std::vector<T>& values);
+  bool readDependencies(std::unordered_map<int, std::vector<int>>& dependencies);
+  bool readExtendedDependencies(ExtendedDependencies& extended_dependencies);
+  bool readClauses(ClauseDatabase& clauses);
+  bool atEnd() const;
+
+ private:
+  const char* data;
+  size_t size;
+  size_t position;
+
+};
+
+SnapshotReader::SnapshotReader(const char* data, size_t size) : data(data), size(size), position(0) {
+}
+
+bool SnapshotReader::skip(size_t bytes) {
+  if (size - position < bytes) {
+    return false;
+  }
+  position += bytes;
+  return true;
+}
+
+bool SnapshotReader::atEnd() const {
+  return position == size;
+}
+
+template<class T> bool SnapshotReader::readValue(T& value) {
+  if (size - position < sizeof(T)) {
+    return false;
+  }
+  memcpy(&value, data + position, sizeof(T));
+  position += sizeof(T);
+  return true;
+}
+
+template<class T> bool SnapshotReader::readArray(std::vector<T>& values) {
+  uint64_t count;
+  if (!readValue(count) || count > (size - position) / sizeof(T)) {
+    return false;
+  }
+  values.resize(count);
+  memcpy(values.data(), data + position, count * sizeof(T));
+  position += count * sizeof(T);
+  position = std::min(size, position + (8 - position % 8) % 8);
+  return true;
+}
+
+static bool isValidOffsetArray(const std::vector<size_t>& offsets, size_t number_of_values) {
+  if (offsets.empty() || offsets.front() != 0 || offsets.back() != number_of_values) {
+    return false;
+  }
+  for (size_t i = 1; i < offsets.size(); i++) {
+    if (offsets[i] < offsets[i - 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SnapshotReader::readDependencies(std::unordered_map<int, std::vector<int>>& dependencies) {
+  std::vector<int> variables;
+  std::vector<size_t> offsets;
+  std::vector<int> values;
+  if (!readArray(variables) || !readArray(offsets) || !readArray(values) ||
+      offsets.size() != variables.size() + 1 || !isValidOffsetArray(offsets, values.size())) {
+    return false;
+  }
+  dependencies.clear();
+  dependencies.reserve(variables.size());
+  for (size_t i = 0; i < variables.size(); i++) {
+    dependencies[variables[i]] = std::vector<int>(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
+  }
+  return true;
+}
+
+static bool isValidVariableArray(const std::vector<int>& variables) {
+  return std::all_of(variables.begin(), variables.end(), [](int v) { return v > 0; });
+}
+
+bool SnapshotReader::readExtendedDependencies(ExtendedDependencies& extended_dependencies) {
+  std::vector<int> universals, existentials, explicit_variables;
+  std::vector<size_t> block_offsets, thresholds;
+  if (!readArray(universals) || !readArray(block_offsets) || !readArray(existentials) ||
+      !readArray(explicit_variables) || !readArray(thresholds)) {
+    return false;
+  }
+  if (!isValidVariableArray(universals) || !isValidVariableArray(existentials) || !isValidVariableArray(explicit_variables) ||
+      !isValidOffsetArray(block_offsets, universals.size()) || explicit_variables.size() != thresholds.size() ||
+      !std::is_sorted(thresholds.begin(), thresholds.end())) {
+    return false;
+  }
+  std::vector<int> variables;
+  std::vector<size_t> nof_universal_blocks, existential_ranks;
+  std::vector<uint8_t> explicit_thresholds;
+  ClauseDatabase entry_variables;
+  if (!readArray(variables) || !readArray(nof_universal_blocks) || !readArray(existential_ranks) ||
+      !readArray(explicit_thresholds) || !readClauses(entry_variables)) {
+    return false;
+  }
+  if (nof_universal_blocks.size() != variables.size() || existential_ranks.size() != variables.size() ||
+      explicit_thresholds.size() != variables.size() || entry_variables.size() != variables.size()) {
+    return false;
+  }
+
+  ExtendedDependencies result;
+  result.setUniversalBlocks(universals, block_offsets);
+  result.setExistentialOrder(existentials);
+  // The variables are stored in the order of their thresholds, thus they can be added without searching.
+  for (size_t i = 0; i < explicit_variables.size(); i++) {
+    auto variable = explicit_variables[i];
+    if (static_cast<size_t>(variable) >= result.explicit_threshold.size()) {
+      result.explicit_threshold.resize(variable + 1, ExtendedDependencies::none);
+    }
+    result.explicit_threshold[variable] = thresholds[i];
+    result.explicit_by_threshold.emplace_back(thresholds[i], variable);
+  }
+  result.entries.reserve(variables.size());
+  for (size_t i = 0; i < variables.size(); i++) {
+    auto entry_dependencies = entry_variables[i];
+    if (!std::is_sorted(entry_dependencies.begin(), entry_dependencies.end())) {
+      return false;
+    }
+    auto& entry = result.entries[variables[i]];
+    entry.nof_universal_blocks = nof_universal_blocks[i];
+    entry.existential_rank = existential_ranks[i];
+    entry.explicit_thresholds = explicit_thresholds[i];
+    entry.variables = entry_dependencies.toClause();
+    result.updateSize(entry);
+  }
+  extended_dependencies = std::move(result);
+  return true;
+}
+
+bool SnapshotReader::readClauses(ClauseDatabase& clauses) {
+  std::vector<int> literals;
+  std::vector<size_t> offsets;
+  if (!readArray(literals) || !readArray(offsets) || !isValidOffsetArray(offsets, literals.size())) {
+    return false;
+  }
+  clauses = ClauseDatabase(std::move(literals), std::move(offsets));
+  return true;
+}
+
+bool FormulaSnapshot::checksum(const std::string& fname, uint64_t& result) {
+  MappedFile input;
+  if (!input.open(fname)) {
+    return false;
+  }
+  SnapshotHash hash;
+  hash.update(input.data(), input.size());
+  result = hash.digest();
+  return true;
+}
+
+uint64_t FormulaSnapshot::fingerprint(const Configuration& config) {
+  uint64_t result = 0;
+  result |= static_cast<uint64_t>(config.apply_dependency_schemes);
+  result |= static_cast<uint64_t>(config.apply_forall_reduction) << 1;
+  result |= static_cast<uint64_t>(config.extended_dependencies) << 2;
+  result |= static_cast<uint64_t>(config.ignore_innermost_existentials) << 3;
+  return result;
+}
+
+bool FormulaSnapshot::write(const std::string& fname, const InputFormula& formula, uint64_t source_checksum, uint64_t configuration_fingerprint) {
+  // Write to a temporary file with a unique name in the same directory first and rename it afterwards.
+  // Thus, concurrent runs never see a partially written snapshot and do not write into the same file.
+  std::vector<char> temporary_fname(fname.begin(), fname.end());
+  const std::string suffix = ".XXXXXX";
+  temporary_fname.insert(temporary_fname.end(), suffix.begin(), suffix.end());
+  temporary_fname.push_back('\0');
+  int file_descriptor = mkstemp(temporary_fname.data());
+  if (file_descriptor < 0) {
+    return false;
+  }
+  // mkstemp creates the file only readable by the owner, the snapshot gets the usual permissions instead.
+  auto mask = umask(0);
+  umask(mask);
+  fchmod(file_descriptor, 0666 & ~mask);
+  ::close(file_descriptor);
+  auto remove_temporary_file = [&temporary_fname]() {
+    std::remove(temporary_fname.data());
+    return false;
+  };
+  {
+    std::ofstream out(temporary_fname.data(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return remove_temporary_file();
+    }
+    SnapshotWriter writer(out);
+    writer.writeBytes(snapshot_magic, sizeof(snapshot_magic));
+    writer.writeValue(format_version);
+    writer.writeValue(byte_order_mark);
+    writer.writeValue(source_checksum);
+    writer.writeValue(configuration_fingerprint);
+
+    writer.writeArray(formula.matrix.getLiterals());
+    writer.writeArray(formula.matrix.getOffsets());
+    writer.writeArray(formula.universal_variables);
+    writer.writeArray(formula.existential_variables);
+    writer.writeDependencies(formula.dependencies);
+    writer.writeExtendedDependencies(formula.extended_dependenices);
+    writer.writeValue<uint64_t>(formula.innermost_existential_block_present);
+    writer.writeValue<uint64_t>(formula.start_index_innermost_existentials);
+    writer.writeValue<uint64_t>(formula.end_index_innermost_existentials);
+    writer.writeValue<int64_t>(formula.max_used_variable);
+
+    std::map<int, const std::tuple<std::vector<Clause>, Circuit>*> sorted_definitions;
+    for (const auto& [variable, definition]: formula.definitions) {
+      sorted_definitions[variable] = &definition;
+    }
+    writer.writeValue<uint64_t>(sorted_definitions.size());
+    for (const auto& [variable, definition]: sorted_definitions) {
+      const auto& [definition_clauses, definition_circuit] = *definition;
+      ClauseDatabase clauses(definition_clauses);
+      std::vector<int> gate_outputs;
+      ClauseDatabase gate_inputs;
+      for (const auto& [inputs, output]: definition_circuit) {
+        gate_outputs.push_back(output);
+        gate_inputs.addClause(inputs);
+      }
+      writer.writeValue<int64_t>(variable);
+      writer.writeArray(clauses.getLiterals());
+      writer.writeArray(clauses.getOffsets());
+      writer.writeArray(gate_outputs);
+      writer.writeArray(gate_inputs.getLiterals());
+      writer.writeArray(gate_inputs.getOffsets());
+    }
+    writer.writeTrailer();
+    out.close();
+    if (!out) {
+      return remove_temporary_file();
+    }
+  }
+  if (std::rename(temporary_fname.data(), fname.c_str()) != 0) {
+    return remove_temporary_file();
+  }
+  return true;
+}
+
+bool FormulaSnapshot::read(const std::string& fname, uint64_t source_checksum, uint64_t configuration_fingerprint, InputFormula& formula) {
+  MappedFile input;
+  if (!input.open(fname) || input.size() < sizeof(snapshot_magic) || memcmp(input.data(), snapshot_magic, sizeof(snapshot_magic)) != 0) {
+    return false;
+  }
+  // The trailer holds the length and the hash of the rest of the file, a damaged snapshot is rejected before it is parsed.
+  uint64_t trailer[2];
+  if (input.size() < sizeof(trailer)) {
+    return false;
+  }
+  size_t payload_size = input.size() - sizeof(trailer);
+  memcpy(trailer, input.data() + payload_size, sizeof(trailer));
+  SnapshotHash hash;
+  hash.update(input.data(), payload_size);
+  if (trailer[0] != payload_size || trailer[1] != hash.digest()) {
+    return false;
+  }
+  SnapshotReader reader(input.data(), payload_size);
+  uint32_t version, byte_order;
+  uint64_t checksum_in_file, fingerprint_in_file;
+  if (!reader.skip(sizeof(snapshot_magic)) || !reader.readValue(version) || !reader.readValue(byte_order) ||
+      !reader.readValue(checksum_in_file) || !reader.readValue(fingerprint_in_file)) {
+    return false;
+  }
+  if (version != format_version || byte_order != byte_order_mark ||
+      checksum_in_file != source_checksum || fingerprint_in_file != configuration_fingerprint) {
+    return false;
+  }
+
+  InputFormula result;
+  uint64_t innermost_present, innermost_start, innermost_end;
+  int64_t max_used_variable;
+  if (!reader.readClauses(result.matrix) ||
+      !reader.readArray(result.universal_variables) ||
+      !reader.readArray(result.existential_variables) ||
+      !reader.readDependencies(result.dependencies) ||
+      !reader.readExtendedDependencies(result.extended_dependenices) ||
+      !reader.readValue(innermost_present) ||
+      !reader.readValue(innermost_start) ||
+      !reader.readValue(innermost_end) ||
+      !reader.readValue(max_used_variable)) {
+    return false;
+  }
+  if (innermost_start > innermost_end || innermost_end > result.existential_variables.size()) {
+    return false;
+  }
+  result.innermost_existential_block_present = innermost_present;
+  result.start_index_innermost_existentials = innermost_start;
+  result.end_index_innermost_existentials = innermost_end;
+  result.max_used_variable = max_used_variable;
+
+  uint64_t number_of_definitions;
+  if (!reader.readValue(number_of_definitions)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < number_of_definitions; i++) {
+    int64_t variable;
+    ClauseDatabase clauses, gate_inputs;
+    std::vector<int> gate_outputs;
+    if (!reader.readValue(variable) || !reader.readClauses(clauses) ||
+        !reader.readArray(gate_outputs) || !reader.readClauses(gate_inputs) || gate_outputs.size() != gate_inputs.size()) {
+      return false;
+    }
+    Circuit circuit;
+    circuit.reserve(gate_outputs.size());
+    for (size_t j = 0; j < gate_outputs.size(); j++) {
+      circuit.emplace_back(gate_inputs[j].toClause(), gate_outputs[j]);
+    }
+    result.definitions[variable] = std::make_tuple(clauses.toClauses(), std::move(circuit));
+  }
+  if (!reader.atEnd()) {
+    return false;
+  }
+  formula = std::move(result);
+  return true;
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef PEDANT_FORMULA_SNAPSHOT_H_
+#define PEDANT_FORMULA_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "inputformula.h"
+#include "configuration.h"
+
+namespace pedant {
+
+/**
+ * Binary snapshot of a preprocessed formula (matrix, prefix, dependencies, extended dependencies and definitions).
+ * The file starts with a header containing a format version, a checksum of the source file and a fingerprint of the
+ * preprocessing options. All arrays are stored with 8 byte alignment so the file can be memory-mapped.
+ * The file ends with a trailer containing the length and a hash of the preceding bytes.
+ **/
+class FormulaSnapshot {
+
+ public:
+  /**
+   * Computes a checksum of the contents of the given file. Returns false if the file could not be read.
+   **/
+  static bool checksum(const std::string& fname, uint64_t& result);
+  /**
+   * Fingerprint of the options that influence the result of the preprocessing.
+   **/
+  static uint64_t fingerprint(const Configuration& config);
+
+  static bool write(const std::string& fname, const InputFormula& formula, uint64_t source_checksum, uint64_t configuration_fingerprint);
+  /**
+   * Loads the snapshot into formula. Returns false if the file does not exist, is corrupt, was written by a
+   * different version or does not match the checksum of the source file and the fingerprint of the options.
+   **/
+  static bool read(const std::string& fname, uint64_t source_checksum, uint64_t configuration_fingerprint, InputFormula& formula);
+
+ private:
+  static constexpr uint32_t format_version = 3;
+  static constexpr uint32_t byte_order_mark = 0x01020304;
+
+};
+
+}
+
+#endif // PEDANT_FORMULA_SNAPSHOT_H_
@@ -1,249 +1,319 @@
-#include <cassert>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
 
 #include "graphSeparator.h"
 
 
 namespace pedant {
 
-std::vector<int> GraphSeparator::getVertexSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges, 
+std::vector<int> GraphSeparator::getVertexSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
                                                     const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
                                                     const std::vector<int>& to_avoid) {
-  GraphSeparator gP(vertices,edges);
-  std::vector<int> sep = gP.getVertexSeparator(vertA, vertB, forbidden, to_avoid);
-  return sep;
+  static thread_local GraphSeparator workspace;
+  workspace.indexVertices(vertices);
+  if (sinkSetIsSeparator(vertA, vertB, forbidden)) {
+    // Report the vertices in the order of their nodes, as the cut does.
+    std::vector<size_t> indices;
+    for (auto v : vertB) {
+      auto it = workspace.vertex_indices.find(v);
+      if (it != workspace.vertex_indices.end()) {
+        indices.push_back(it->second);
+      }
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    std::vector<int> separator;
+    for (auto i : indices) {
+      separator.push_back(vertices[i]);
+    }
+    return separator;
+  }
+  workspace.build(edges, vertA, vertB, forbidden, to_avoid);
+  workspace.finalize();
+  workspace.maxFlow();
+  return workspace.separatorFromResidualGraph();
 }
 
-
-GraphSeparator::GraphSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges) : vertex_names(vertices) {
-  auto capacity = get(boost::edge_capacity, g);
-  auto rev = get(boost::edge_reverse, g);
-  std::vector<Traits::vertex_descriptor> verts;
-  verts.reserve(2*vertices.size()+2);
-  //we add a source and a sink vertex and each original vertex is represented by an in and an out vertex
-  for (long vi = 0; vi < 2*vertices.size()+2; ++vi) {
-    verts.push_back(add_vertex(g));
+bool GraphSeparator::sinkSetIsSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden) {
+  if (vertB.size() > vertA.size()) {
+    return false;
   }
-
-  for (int i=0; i<vertices.size(); i++) {
-    int v = vertices[i];
-    vertex_indices[v] = 2*i+1;
-    //setup "internal" edges
-    addEdge(verts[2*i+1], verts[2*i+2], capacity, rev);
+  std::unordered_set<int> sources(vertA.begin(), vertA.end());
+  for (auto v : vertB) {
+    if (sources.find(v) == sources.end()) {
+      return false;
+    }
   }
-
-  for (auto [source, target] : edges) {
-    int idx1 = vertex_indices[source] + 1; //we have to use the out node from the internal edge representation
-    int idx2 = vertex_indices[target];
-    addEdge(verts[idx1], verts[idx2], capacity, rev);
-  } 
-
-  auto source=verts.front(), sink=verts.back();
-}
-
-
-void GraphSeparator::addEdge(Traits::vertex_descriptor source, Traits::vertex_descriptor target, 
-    boost::property_map<Graph,boost::edge_capacity_t>::type& capacity, 
-    boost::property_map<Graph,boost::edge_reverse_t>::type& reverse, int weight) {
-  Traits::edge_descriptor e1, e2;
-  bool in1, in2;
-  boost::tie(e1, in1) = add_edge(source, target, g);
-  boost::tie(e2, in2) = add_edge(target, source, g);
-  capacity[e1] = weight;
-  capacity[e2] = 0;
-  reverse[e1] = e2;
-  reverse[e2] = e1;
-}
-
-void GraphSeparator::connectToSource(const std::vector<int>& to_connect,
-    std::vector<Traits::vertex_descriptor>& verts,
-    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
-    boost::property_map < Graph, boost::edge_reverse_t >::type& rev,
-    unsigned int penalty) {
-  for (int v : to_connect) {
-    int idx = vertex_indices[v];
-    addEdge(verts.front(), verts[idx], capacity, rev, penalty);
+  for (auto f : forbidden) {
+    if (std::find(vertB.begin(), vertB.end(), f) != vertB.end()) {
+      return false;
+    }
   }
+  return true;
 }
 
-
-void GraphSeparator::connectToSink(const std::vector<int>& to_connect,
-    std::vector<Traits::vertex_descriptor>& verts,
-    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
-    boost::property_map < Graph, boost::edge_reverse_t >::type& rev) {
-  for (int v : to_connect) {
-    int idx = vertex_indices[v];
-    addEdge(verts[idx+1], verts.back(), capacity, rev, external_capacity); //we want to cut internal edges thus we give the actual edges a higher capacity
+void GraphSeparator::indexVertices(const std::vector<int>& vertices) {
+  vertex_names = vertices;
+  vertex_indices.clear();
+  //we add a source and a sink vertex and each original vertex is represented by an in and an out vertex
+  nof_nodes = 2 * vertices.size() + 2;
+  for (size_t i = 0; i < vertices.size(); i++) {
+    vertex_indices[vertices[i]] = i;
   }
 }
 
-std::vector<int> GraphSeparator::getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB) {
-  return getVertexSeparator(vertA, vertB, {}, {});
-}
+void GraphSeparator::build(const std::vector<std::pair<int,int>>& edges, const std::vector<int>& vertA,
+                           const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& unpreferred) {
+  const auto& vertices = vertex_names;
+  edge_list.clear();
 
-std::vector<int> GraphSeparator::getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& unpreferred) {
-  auto [vert_beg, vert_end] = vertices(g);
-  std::vector<Traits::vertex_descriptor> verts(vert_beg,vert_end);
-  auto capacity = get(boost::edge_capacity, g);
-  auto rev = get(boost::edge_reverse, g);
   //Assuming unpreferred is empty the max flow is bounded from above by |vertA|*internal_capacity.
   //Every path connecting the source with the sink has to pass through an internal edge of vertA.
   //As these have capacity internal_capacity we get the bound.
   //If we increase this value by one we can thus be sure that no edge with this capacity can be saturated
   //(vertA and forbidden has to be disjoint)
-  int penalty = internal_capacity * vertA.size() + 1;
+  long penalty = internal_capacity * static_cast<long>(vertA.size()) + 1;
   //If unpreferred is not empty then the value given above is not necessarily a bound.
   //Thus, we have to increase it.
   penalty += unpreferred.size();
+
+  //Forbidden vertices get the penalty both on their internal edges and on their outgoing edges.
+  //If we would not apply it to the outgoing edges we could get a cut in such an edge.
+  //By using a higher capacity as for the "standard" internal edges the internal
+  //edges for the unpreferred are only used if they are really needed.
+  internal_capacities.assign(vertices.size(), internal_capacity);
+  outgoing_penalties.assign(vertices.size(), 0);
+  auto apply_penalty = [this](const std::vector<int>& to_apply, long capacity) {
+    for (auto v : to_apply) {
+      auto it = vertex_indices.find(v);
+      if (it != vertex_indices.end()) {
+        internal_capacities[it->second] = capacity;
+        outgoing_penalties[it->second] = capacity;
+      }
+    }
+  };
+  apply_penalty(forbidden, penalty);
+  apply_penalty(unpreferred, unpreferred_capacity);
+
+  for (size_t i = 0; i < vertices.size(); i++) {
+    //setup "internal" edges, a vertex that occurs more than once is only connected through its last occurrence
+    auto capacity = vertex_indices[vertices[i]] == static_cast<int>(i) ? internal_capacities[i] : internal_capacity;
+    addEdge(inNode(i), outNode(i), capacity);
+  }
+  for (auto [tail, head] : edges) {
+    auto tail_it = vertex_indices.find(tail);
+    auto head_it = vertex_indices.find(head);
+    if (tail_it == vertex_indices.end() || head_it == vertex_indices.end()) {
+      continue;
+    }
+    auto penalty_of_tail = outgoing_penalties[tail_it->second];
+    addEdge(outNode(tail_it->second), inNode(head_it->second), penalty_of_tail > 0 ? penalty_of_tail : internal_capacity);
+  }
   //We never want to have an edge from the original graph (i.e. a non internal edge)
   //in the edge separator. Usually, this is ensured by preceeding internal edges with a lower
   //capacity. But in the case of the outgoing edges of the source there is no such internal edge,
   //thus we have to apply the penalty.
-  connectToSource(vertA, verts, capacity, rev, penalty);
-  connectToSink(vertB, verts, capacity, rev);
-  //We know that every path from the source vertex to the sink vertex has to contain an element of vertB.
-  //Morever, we know that in the used representation each vertex is represented by an in and an out vertex.
-  //As forbidden and vertB have to be disjoint we also know that the capacities for the edges 
-  //connecting the in and out vertices for the elements in forbidden are 1.
-  //This means that the maximal flow is at most vertB.size(). 
-  //This means by applying a capacity of vertB.size()+1 we ensure that the edge will not be saturated.
-  //So this edge will not be part of the edge-separator.
-  applyPenalties(forbidden,verts,capacity,penalty);
-
-  //If we can swap an unpreferred vertex in the vertex separator with another
-  //vertex we want to do this as long as this does not increase the size of the separator.
-  //By using a higher capacity as for the "standard" internal edges the internal
-  //edges for the unpreferred are only used if they are really needed
-  applyPenalties(unpreferred, verts, capacity, unpreferred_capacity);
-
-
-  // long flow = push_relabel_max_flow(g, verts.front(), verts.back()); Do not use this algorithm
-  long flow = boykov_kolmogorov_max_flow(g, verts.front(), verts.back());
-  // long flow = edmonds_karp_max_flow(g, verts.front(), verts.back());
-
-  auto sep_edges = getSeparatingEdges(verts.front());
-  // saveGraph();//TEST:
-  auto sep_verts = vertexSeparatorFromEdgeSeparator(sep_edges);
-  // assert (sep_verts.size() == flow); with unpreferred vertices this does not necessarily hold
-  return sep_verts;
+  for (auto v : vertA) {
+    auto it = vertex_indices.find(v);
+    if (it != vertex_indices.end()) {
+      addEdge(source, inNode(it->second), penalty);
+    }
+  }
+  //we want to cut internal edges thus we give the edges to the sink a higher capacity
+  for (auto v : vertB) {
+    auto it = vertex_indices.find(v);
+    if (it != vertex_indices.end()) {
+      auto penalty_of_vertex = outgoing_penalties[it->second];
+      addEdge(outNode(it->second), sink(), penalty_of_vertex > 0 ? penalty_of_vertex : external_capacity);
+    }
+  }
 }
 
+void GraphSeparator::addEdge(size_t tail, size_t head, long capacity) {
+  edge_list.push_back({tail, head, capacity});
+}
 
-
-void GraphSeparator::applyPenalties(const std::vector<int>& forbidden, 
-    std::vector<Traits::vertex_descriptor>& verts, 
-    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty) {
-  for (int f : forbidden) {
-    applyPenalty(f, verts, capacity, penalty);
+void GraphSeparator::finalize() {
+  first_arc.assign(nof_nodes + 1, 0);
+  for (const auto& edge : edge_list) {
+    first_arc[edge.tail + 1]++;
+    first_arc[edge.head + 1]++;
+  }
+  for (size_t v = 0; v < nof_nodes; v++) {
+    first_arc[v + 1] += first_arc[v];
+  }
+  auto nof_arcs = first_arc.back();
+  arc_head.resize(nof_arcs);
+  arc_capacity.resize(nof_arcs);
+  arc_residual.resize(nof_arcs);
+  arc_reverse.resize(nof_arcs);
+  current_arc.assign(first_arc.begin(), first_arc.end() - 1);
+  for (const auto& edge : edge_list) {
+    auto forward = current_arc[edge.tail]++;
+    auto backward = current_arc[edge.head]++;
+    arc_head[forward] = edge.head;
+    arc_capacity[forward] = edge.capacity;
+    arc_residual[forward] = edge.capacity;
+    arc_reverse[forward] = backward;
+    arc_head[backward] = edge.tail;
+    arc_capacity[backward] = 0;
+    arc_residual[backward] = 0;
+    arc_reverse[backward] = forward;
   }
 }
 
-void GraphSeparator::applyPenalty(int to_apply, std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty) {
-  //We have to apply the penalty both to the internal edges as to all the outgoing edges of the forbidden vertices.
-  //If we would not apply it to the outgoing edges we could get a cut in such an edge. 
-  int idx=vertex_indices[to_apply];
-  auto internal_edge = boost::edge(verts[idx],verts[idx+1],g).first;
-  capacity[internal_edge] = penalty;
-  boost::graph_traits < Graph >::out_edge_iterator ei, e_end;
-  for (boost::tie(ei, e_end) = boost::out_edges(verts[idx+1], g); ei != e_end; ++ei) {
-    if (capacity[*ei] > 0) { //it is an outgoing edge
-      capacity[*ei] = penalty;
+bool GraphSeparator::computeLevels() {
+  level.assign(nof_nodes, -1);
+  node_queue.clear();
+  node_queue.push_back(source);
+  level[source] = 0;
+  for (size_t next = 0; next < node_queue.size(); next++) {
+    auto v = node_queue[next];
+    for (auto a = first_arc[v]; a < first_arc[v + 1]; a++) {
+      auto w = arc_head[a];
+      if (arc_residual[a] > 0 && level[w] < 0) {
+        level[w] = level[v] + 1;
+        node_queue.push_back(w);
+      }
     }
   }
+  return level[sink()] >= 0;
 }
 
-void GraphSeparator::removePenalty(int to_remove, std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity) {
-  int idx=vertex_indices[to_remove];
-  auto internal_edge = boost::edge(verts[idx],verts[idx+1],g).first;
-  capacity[internal_edge] = 1;
-  boost::graph_traits < Graph >::out_edge_iterator ei, e_end;
-  for (boost::tie(ei, e_end) = boost::out_edges(verts[idx+1], g); ei != e_end; ++ei) {
-    if (capacity[*ei] > 0) { //it is an outgoing edge
-      capacity[*ei] = 2;
+/**
+ * Dinic's algorithm. The augmenting paths of a phase are searched iteratively, nodes from which the sink cannot be reached
+ * along the levels are removed from the level graph.
+ **/
+long GraphSeparator::maxFlow() {
+  long flow = 0;
+  while (computeLevels()) {
+    current_arc.assign(first_arc.begin(), first_arc.end() - 1);
+    path.clear();
+    size_t v = source;
+    while (true) {
+      if (v == sink()) {
+        long bottleneck = std::numeric_limits<long>::max();
+        for (auto a : path) {
+          bottleneck = std::min(bottleneck, arc_residual[a]);
+        }
+        for (auto a : path) {
+          arc_residual[a] -= bottleneck;
+          arc_residual[arc_reverse[a]] += bottleneck;
+        }
+        flow += bottleneck;
+        // Continue from the tail of the first saturated arc.
+        size_t k = 0;
+        while (arc_residual[path[k]] > 0) {
+          k++;
+        }
+        path.resize(k);
+        v = path.empty() ? source : arc_head[path.back()];
+        continue;
+      }
+      auto& a = current_arc[v];
+      while (a < first_arc[v + 1] && (arc_residual[a] == 0 || level[arc_head[a]] != level[v] + 1)) {
+        a++;
+      }
+      if (a < first_arc[v + 1]) {
+        path.push_back(a);
+        v = arc_head[a];
+      } else if (v == source) {
+        break;
+      } else {
+        // Dead end.
+        level[v] = -1;
+        path.pop_back();
+        v = path.empty() ? source : arc_head[path.back()];
+        current_arc[v]++;
+      }
     }
   }
+  return flow;
 }
 
-std::vector<int> GraphSeparator::vertexSeparatorFromEdgeSeparator(const std::vector<GraphSeparator::Traits::edge_descriptor>& edge_separator) {
-  auto index_map = get(boost::vertex_index, g);
+/**
+ * The separator consists of the vertices whose internal edge leaves the set of nodes that are reachable from the source in the residual graph.
+ * Due to the capacities the cut should not contain other edges. If it does nevertheless, the vertex of the tail of the edge
+ * is added, which keeps the result a separator.
+ **/
+std::vector<int> GraphSeparator::separatorFromResidualGraph() {
+  std::vector<char> reachable(nof_nodes, 0);
+  node_queue.clear();
+  node_queue.push_back(source);
+  reachable[source] = 1;
+  for (size_t next = 0; next < node_queue.size(); next++) {
+    auto v = node_queue[next];
+    for (auto a = first_arc[v]; a < first_arc[v + 1]; a++) {
+      auto w = arc_head[a];
+      if (arc_residual[a] > 0 && !reachable[w]) {
+        reachable[w] = 1;
+        node_queue.push_back(w);
+      }
+    }
+  }
+  std::vector<char> in_separator(vertex_names.size(), 0);
+  for (auto v : node_queue) {
+    for (auto a = first_arc[v]; a < first_arc[v + 1]; a++) {
+      if (arc_capacity[a] > 0 && !reachable[arc_head[a]]) {
+        auto node = (v == source) ? arc_head[a] : v;
+        in_separator[(node - 1) / 2] = 1;
+      }
+    }
+  }
   std::vector<int> vertex_separator;
-  vertex_separator.reserve(edge_separator.size());
-  for (auto edge : edge_separator) {
-    auto s = boost::source(edge,g);
-    auto t = boost::target(edge,g);
-    auto s_idx = index_map[s];
-    auto t_idx = index_map[t];
-    assert (t_idx == s_idx+1);
-    int vertex_index = t_idx/2;
-    //in the internal representation the source has index 0, thus we have to subtract 1
-    vertex_separator.push_back(vertex_names[vertex_index-1]);
+  for (size_t i = 0; i < vertex_names.size(); i++) {
+    if (in_separator[i]) {
+      vertex_separator.push_back(vertex_names[i]);
+    }
   }
   return vertex_separator;
 }
 
-std::vector<bool> GraphSeparator::reachableInResidualGraph(Traits::vertex_descriptor& source) {
-  auto residual_capacity = get(boost::edge_residual_capacity, g);
-  auto nof_vertices = num_vertices(g);
-  std::vector<bool> vertex_reachable(nof_vertices,false);
-  std::queue<Traits::vertex_descriptor> queued_vertices;
-  queued_vertices.push(source);
-  auto index_map = get(boost::vertex_index, g);
-  auto index = index_map[source];
-  vertex_reachable[index] = true;
-  while(!queued_vertices.empty()) {
-    auto vert = queued_vertices.front();
-    queued_vertices.pop();
-    boost::graph_traits < Graph >::out_edge_iterator ei, e_end;
-    for (boost::tie(ei, e_end) = out_edges(vert, g); ei != e_end; ++ei) {
-      if (residual_capacity[*ei] > 0) {
-        auto v = boost::target(*ei,g);
-        auto idx = index_map[v];
-        if (!vertex_reachable[idx]) {
-          vertex_reachable[idx] = true;
-          queued_vertices.push(v);
-        }
+void GraphSeparator::saveGraph(const std::string& filename) const {
+  std::ofstream file(filename);
+  auto name = [this](size_t node) {
+    if (node == source) {
+      return std::string("source");
+    } else if (node == sink()) {
+      return std::string("sink");
+    }
+    return std::to_string(vertex_names[(node - 1) / 2]) + ((node % 2 == 1) ? " in" : " out");
+  };
+  file << "digraph G {" << std::endl;
+  for (size_t v = 0; v < nof_nodes; v++) {
+    for (auto a = first_arc[v]; a < first_arc[v + 1]; a++) {
+      if (arc_capacity[a] > 0) { //original edge
+        file << "\"" << name(v) << "\" -> \"" << name(arc_head[a]) << "\";" << std::endl;
       }
     }
   }
-  return vertex_reachable;
+  file << "}" << std::endl;
 }
 
-
-/**
- * At first glance the boost::stoer_wagner_min_cut method seems to be capable of getting the required edges.
- * First of all this method does not give the required edges -- the edges have to be computed from a parity map.
- * But more importantly we cannot specify a source and a sink. This means that the method could possibly determine a wrong cut.
- **/
-std::vector<GraphSeparator::Traits::edge_descriptor> GraphSeparator::getSeparatingEdges(Traits::vertex_descriptor& source) {
-  std::vector<bool> vertex_reachable = reachableInResidualGraph(source);
-
-  auto [vert_beg, vert_end] = vertices(g);
-  std::vector<Traits::vertex_descriptor> verts(vert_beg,vert_end);
-  auto capacity = get(boost::edge_capacity, g);
-  auto rev = get(boost::edge_reverse, g);
-  auto index_map = get(boost::vertex_index, g);
-
-  std::vector<Traits::edge_descriptor> result;
-
-  for (int idx = 0; idx<vertex_reachable.size();idx++) {
-    if (!vertex_reachable[idx]) {
-      for (auto [ei,e_end] = out_edges(verts[idx], g); ei != e_end; ++ei) {
-        if (capacity[*ei] == 0) { //a capacity of 0 effectively means that this edge is an input edge
-          auto t = boost::target(*ei,g);
-          auto idx = index_map[t];
-          if (vertex_reachable[idx]) {
-            auto rev_edge = rev[*ei];
-            result.push_back(rev_edge);
-          }
-        }
-      }
+void GraphSeparator::saveInstance(const std::string& filename, const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
+                                  const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
+                                  const std::vector<int>& to_avoid) {
+  std::ofstream file(filename);
+  auto write_line = [&file](const std::string& name, const std::vector<int>& values) {
+    file << name;
+    for (auto v : values) {
+      file << " " << v;
     }
+    file << std::endl;
+  };
+  write_line("vertices", vertices);
+  file << "edges";
+  for (auto [tail, head] : edges) {
+    file << " " << tail << " " << head;
   }
-  return result;
+  file << std::endl;
+  write_line("sources", vertA);
+  write_line("sinks", vertB);
+  write_line("forbidden", forbidden);
+  write_line("unpreferred", to_avoid);
 }
 
 
-
-
-}
\ No newline at end of file
+}
@@ -1,84 +1,122 @@
+#ifndef PEDANT_GRAPHSEPARATOR_H_
+#define PEDANT_GRAPHSEPARATOR_H_
+
+#include <cstddef>
 #include <string>
 #include <vector>
-// #include <set>
 #include <unordered_map>
-#include <queue>
-
-#include <boost/config.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/graph_utility.hpp>
-
-#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
-// #include <boost/graph/push_relabel_max_flow.hpp>
-#include <boost/graph/edmonds_karp_max_flow.hpp>
-
-//Needed for the visualisation
-#include <boost/graph/graphviz.hpp>
-#include <fstream>
-#include <string>
 
 namespace pedant {
 
 
+/**
+ * Computes minimum vertex separators with a max-flow computation on the usual split graph:
+ * each vertex v is represented by an in node and an out node connected by an "internal" edge, an edge (v,w) of the
+ * graph becomes an edge from the out node of v to the in node of w. A source node is connected to the in nodes of
+ * the first set of vertices, the out nodes of the second set are connected to a sink node.
+ *
+ * The residual graph is stored in compressed sparse row form. The arrays are kept in a thread local workspace and
+ * reused by subsequent calls, so that a call does not allocate once the workspace has grown to the size of the graphs.
+ * The max flow is computed by Dinic's algorithm (BFS levels and augmenting paths along the levels).
+ * The separator is read off the cut given by the nodes that are reachable from the source in the residual graph.
+ * This is the minimum cut closest to the source, thus it does not depend on the max-flow algorithm.
+ **/
 class GraphSeparator {
 
-  typedef boost::adjacency_list_traits < boost::vecS, boost::vecS, boost::directedS > Traits;
-  typedef boost::adjacency_list < boost::vecS, boost::vecS, boost::directedS,
-    boost::property < boost::vertex_name_t, std::string,
-    boost::property < boost::vertex_index_t, long,
-    boost::property < boost::vertex_color_t, boost::default_color_type,
-    boost::property < boost::vertex_distance_t, long,
-    boost::property < boost::vertex_predecessor_t, Traits::edge_descriptor > > > > >,
-    boost::property < boost::edge_capacity_t, long,
-    boost::property < boost::edge_residual_capacity_t, long,
-    boost::property < boost::edge_reverse_t, Traits::edge_descriptor > > > > Graph;
-
-
  public:
 
-  static std::vector<int> getVertexSeparator( const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges, 
-                                              const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
-                                              const std::vector<int>& to_avoid);
-
-  GraphSeparator() = delete;
-  
-  private:
-  
   /**
+   * Computes a vertex separator for vertA and vertB.
+   *
    * @param vertices The vertices of the graph
    * @param edges The edges of the graph
+   * @param vertA A set of vertices. Must be vertices in the represented graph.
+   * @param vertB A set of vertices. Must be vertices in the represented graph.
+   * @param forbidden A set of vertices. The elements of forbidden shall not be contained in the computed vertex separator.
+   *      forbidden and vertB shall be disjoint -- without applying any restriction forbiding vertices could imply that there is no separator.
+   * @param to_avoid A set of vertices which are only contained in the separator if this does not increase its size.
    **/
-  GraphSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges);
+  static std::vector<int> getVertexSeparator( const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
+                                              const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
+                                              const std::vector<int>& to_avoid);
+
+  /** Debug Method
+   * Saves the arguments of getVertexSeparator, so that the call can be replayed by utils/separatorbenchmark.
+   * The file has the lines "vertices", "edges" (tail and head of each edge), "sources", "sinks", "forbidden" and "unpreferred",
+   * each followed by the respective integers.
+   **/
+  static void saveInstance(const std::string& filename, const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
+                           const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
+                           const std::vector<int>& to_avoid);
+
+  GraphSeparator(const GraphSeparator&) = delete;
+  GraphSeparator& operator=(const GraphSeparator&) = delete;
+
+ private:
+
+  GraphSeparator() = default;
 
+  // The source has index 0, vertex i is represented by the nodes 2i+1 (in) and 2i+2 (out), the sink comes last.
+  static constexpr size_t source = 0;
+  static size_t inNode(size_t vertex_index);
+  static size_t outNode(size_t vertex_index);
+  size_t sink() const;
 
+  void indexVertices(const std::vector<int>& vertices);
   /**
-   * Computes a vertex separator for vertA and vertB
-   * 
-   * @param vertA A set of vertices. Must be vertices in the represented graph.
-   * @param vertB A set of vertices. Must be vertices in the represented graph and must be disjoint to vertA. 
-   * 
-   * This method alters the internal representation of the graph, 
-   * so be aware when you reuse this class after the application of this method.
+   * Sets up the edges for the vertices given to indexVertices.
+   * The capacities are explained in the comments of the implementation.
    **/
-  std::vector<int> getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB);
+  void build(const std::vector<std::pair<int,int>>& edges, const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& unpreferred);
+  void addEdge(size_t tail, size_t head, long capacity);
+  // Builds the CSR arrays from edge_list.
+  void finalize();
+  long maxFlow();
+  // Assigns BFS levels in the residual graph, returns false if the sink is not reachable.
+  bool computeLevels();
+  std::vector<int> separatorFromResidualGraph();
 
   /**
-   * Computes a vertex separator for vertA and vertB
-   * 
-   * @param vertA A set of vertices. Must be vertices in the represented graph.
-   * @param vertB A set of vertices. Must be vertices in the represented graph and must be disjoint to vertA. 
-   * @param forbidden A set of vertices. The elements of forbidden shall not be contained in the computed vertex separator.
-   *      forbidden and vertB shall be disjoint -- without applying any restriction forbiding vertices could imply that there is no separator.
-   *      Must be contained in the set of vertices of the current graph.
-   * 
-   * This method alters the internal representation of the graph, 
-   * so be aware when you reuse this class after the application of this method.
+   * If every vertex of vertB is also a vertex of vertA and none of them is forbidden, each of them has a private path
+   * source -> in -> out -> sink whose internal edge is the cheapest one. The unique minimum cut consists of these internal edges.
+   **/
+  static bool sinkSetIsSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden);
+
+  /** Debug Method
+   * Saves the graph (without the reverse edges) in the dot format.
+   * This output can then be visualised by the graphviz tool
+   * (note: this only works if the graph is reasonably small)
    **/
-  std::vector<int> getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& to_avoid);
+  void saveGraph(const std::string& filename) const;
 
-  Graph g;
   std::unordered_map<int,int> vertex_indices;
-  const std::vector<int> vertex_names;
+  std::vector<int> vertex_names;
+  size_t nof_nodes = 0;
+
+  struct Edge {
+    size_t tail;
+    size_t head;
+    long capacity;
+  };
+  std::vector<Edge> edge_list;
+
+  // CSR representation of the residual graph, the arcs of node v are first_arc[v],...,first_arc[v+1]-1.
+  // Each edge is represented by an arc with its capacity and a reverse arc with capacity 0.
+  std::vector<size_t> first_arc;
+  std::vector<size_t> arc_head;
+  std::vector<long> arc_capacity;
+  std::vector<long> arc_residual;
+  std::vector<size_t> arc_reverse;
+
+  // Per vertex data for setting up the capacities, 0 means no penalty.
+  std::vector<long> internal_capacities;
+  std::vector<long> outgoing_penalties;
+
+  // Workspace of the flow computation.
+  std::vector<int> level;
+  std::vector<size_t> current_arc;
+  std::vector<size_t> node_queue;
+  std::vector<size_t> path;
 
   // if unpreferred vertices are sources and we use the boykov kolmogorov the capacities
   // 1 / 2 / 3 would be find. But to increase stability we use 2 / 3 / 4
@@ -90,108 +128,20 @@ class GraphSeparator {
   // default capacity for an edge connection an output and an input vertex
   static constexpr int external_capacity = 4;
 
+};
 
-  
-  /**
-   * @param source The source node.
-   * This method requires that on of the subsequent methods was applied to g (boykov_kolmogorov_max_flow, edmonds_karp_max_flow, push_relabel_max_flow).
-   * The method finds all vertices which are reachable from source in the residual graph (given by the flow algorithm). 
-   * Two vertices are conntected in the residual graph iff there is a path between those vertices in the original graph such that no edge in this path
-   * has a residual capacity of 0.
-   **/
-  std::vector<bool> reachableInResidualGraph(Traits::vertex_descriptor& source);
-
-  /**
-   * This method requires that on of the subsequent methods was applied to g (boykov_kolmogorov_max_flow, edmonds_karp_max_flow, push_relabel_max_flow).
-   * The computed separator is given by the edges that connect vertices that are reachable in the residualgraph with edges that are not reachable.
-   **/
-  std::vector<Traits::edge_descriptor> getSeparatingEdges(Traits::vertex_descriptor& source);
-
-  /**
-   * It has to be ensured that the  given edge separator only contains internal edges.
-   * For each edge (v_in, v_out) the computed separator contains the vertex v.
-   **/
-  std::vector<int> vertexSeparatorFromEdgeSeparator(const std::vector<GraphSeparator::Traits::edge_descriptor>& edge_separator);
-
-  void applyPenalties(const std::vector<int>& forbidden, 
-      std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty);
-
-  void applyPenalty(int to_remove, std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty);
-
-  void removePenalty(int to_remove, std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity);
-
-  void addEdge(Traits::vertex_descriptor source, Traits::vertex_descriptor target, 
-      boost::property_map<Graph,boost::edge_capacity_t>::type& capacity, 
-      boost::property_map<Graph,boost::edge_reverse_t>::type& reverse, int weight = internal_capacity);
-
-  void connectToSource(const std::vector<int>& to_connect, 
-      std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
-      boost::property_map < Graph, boost::edge_reverse_t >::type& rev, unsigned int penalty);
-  void connectToSink(const std::vector<int>& to_connect, 
-      std::vector<Traits::vertex_descriptor>& verts,
-      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
-      boost::property_map < Graph, boost::edge_reverse_t >::type& rev);
-
-
-  /** Debug Method
-   * This method saves the the graph g in the file graph.dot. 
-   * This output can then be visualised by the graphviz tool 
-   * (note: this only works if the graph is reasonably small)
-   **/
-  void saveGraph();
-
-  /** Debug Method
-   * The boost max flow algorithm requires that for each edge also the reverse edge is contained in the graph.
-   * In the visualisation this causes unnecessary noise. 
-   * In this method we create a copy of the graph without the additional edges.
-   **/
-  Graph trimGraph() const;
+inline size_t GraphSeparator::inNode(size_t vertex_index) {
+  return 2 * vertex_index + 1;
+}
 
-};
+inline size_t GraphSeparator::outNode(size_t vertex_index) {
+  return 2 * vertex_index + 2;
+}
 
-inline void GraphSeparator::saveGraph() {
-  std::ofstream file("graph.dot");
-  std::vector<std::string> name_strs;
-  name_strs.push_back("source");
-  for (auto x : vertex_names) {
-    std::string base_name = std::to_string(x);
-    std::string in_vertex = base_name + " in";
-    std::string out_vertex = base_name + " out";
-    name_strs.push_back(in_vertex);
-    name_strs.push_back(out_vertex);
-  }
-  name_strs.push_back("sink");
-  // boost::write_graphviz(file, g, boost::make_label_writer(&name_strs[0]));
-  auto sg = trimGraph();
-  boost::write_graphviz(file, sg, boost::make_label_writer(&name_strs[0]));
-  file.close();
+inline size_t GraphSeparator::sink() const {
+  return nof_nodes - 1;
 }
 
-inline GraphSeparator::Graph GraphSeparator::trimGraph() const {
-  GraphSeparator::Graph simplified_graph;
-  std::vector<Traits::vertex_descriptor> verts;
-  auto [vertex_begin, vertex_end] = vertices(g);
-  for (auto it = vertex_begin; it != vertex_end; it++) {
-    verts.push_back(add_vertex(simplified_graph));
-  }
-  auto [edge_beg, edge_end] = edges(g);
-  auto index_map = get(boost::vertex_index, g);
-  auto capacity = get(boost::edge_capacity, g);
-  for (auto it = edge_beg; it != edge_end; it++) {
-    auto edge = *it;
-    auto s = boost::source(edge,g);
-    auto t = boost::target(edge,g);
-    auto s_idx = index_map[s];
-    auto t_idx = index_map[t];
-    if (capacity[edge] != 0) { //original edge
-      add_edge(verts[s_idx], verts[t_idx], simplified_graph);
-    }
-  }
-  return simplified_graph;
 }
 
-}
\ No newline at end of file
+#endif // PEDANT_GRAPHSEPARATOR_H_
@@ -6,15 +6,17 @@
 #include <algorithm>
 
 #include "solvertypes.h"
+#include "clausedatabase.h"
+#include "extendeddependencies.h"
 
 namespace pedant {
 
 struct InputFormula {
 
  public:
-  std::vector<Clause> matrix;
+  ClauseDatabase matrix;
   std::unordered_map<int, std::vector<int>> dependencies;
-  std::unordered_map<int, std::vector<int>> extended_dependenices;
+  ExtendedDependencies extended_dependenices;
 
   //e.g. tseitin variables
   bool innermost_existential_block_present = false;
@@ -0,0 +1,287 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <vector>
+
+#include <zlib.h>
+#ifdef PEDANT_WITH_LZMA
+#include <lzma.h>
+#endif
+#ifdef PEDANT_WITH_BZIP2
+#include <bzlib.h>
+#endif
+
+#include "inputsource.h"
+
+namespace pedant {
+
+/**
+ * Decodes gzip files (and passes other files through, as gzread does).
+ * A truncated or corrupt file is reported as an error instead of a shorter input, as in Bzip2Source.
+ **/
+class GzipSource : public InputSource {
+
+ public:
+  GzipSource(gzFile file);
+  ~GzipSource();
+  long read(char* buffer, size_t size);
+
+ private:
+  gzFile file;
+
+};
+
+GzipSource::GzipSource(gzFile file) : file(file) {
+  gzbuffer(file, 1 << 17);
+}
+
+GzipSource::~GzipSource() {
+  gzclose(file);
+}
+
+long GzipSource::read(char* buffer, size_t size) {
+  auto bytes_read = gzread(file, buffer, size);
+  if (bytes_read == 0) {
+    // gzread also returns 0 if the input ends in the middle of a stream, in that case the error is Z_BUF_ERROR.
+    int error;
+    gzerror(file, &error);
+    if (error != Z_OK) {
+      return -1;
+    }
+  }
+  return bytes_read;
+}
+
+#ifdef PEDANT_WITH_LZMA
+class XzSource : public InputSource {
+
+ public:
+  XzSource(int file_descriptor);
+  ~XzSource();
+  bool isValid() const;
+  long read(char* buffer, size_t size);
+
+ private:
+  int file_descriptor;
+  lzma_stream stream;
+  std::vector<uint8_t> compressed;
+  bool valid;
+  bool input_finished;
+  bool stream_finished;
+
+};
+
+XzSource::XzSource(int file_descriptor) : file_descriptor(file_descriptor), stream(LZMA_STREAM_INIT),
+    compressed(1 << 17), input_finished(false), stream_finished(false) {
+  valid = lzma_auto_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+}
+
+XzSource::~XzSource() {
+  lzma_end(&stream);
+  close(file_descriptor);
+}
+
+bool XzSource::isValid() const {
+  return valid;
+}
+
+long XzSource::read(char* buffer, size_t size) {
+  if (stream_finished) {
+    return 0;
+  }
+  stream.next_out = reinterpret_cast<uint8_t*>(buffer);
+  stream.avail_out = size;
+  while (stream.avail_out == size) {
+    if (stream.avail_in == 0 && !input_finished) {
+      auto bytes_read = ::read(file_descriptor, compressed.data(), compressed.size());
+      if (bytes_read < 0) {
+        return -1;
+      }
+      input_finished = (bytes_read == 0);
+      stream.next_in = compressed.data();
+      stream.avail_in = bytes_read;
+    }
+    auto result = lzma_code(&stream, input_finished ? LZMA_FINISH : LZMA_RUN);
+    if (result == LZMA_STREAM_END) {
+      stream_finished = true;
+      break;
+    } else if (result != LZMA_OK) {
+      return -1;
+    }
+  }
+  return size - stream.avail_out;
+}
+#endif
+
+#ifdef PEDANT_WITH_BZIP2
+/**
+ * Decodes all concatenated bzip2 streams of the file, as written by pbzip2 or lbzip2.
+ * Data after the last stream that is not a bzip2 stream and truncated streams are reported as errors.
+ **/
+class Bzip2Source : public InputSource {
+
+ public:
+  Bzip2Source(int file_descriptor);
+  ~Bzip2Source();
+  bool isValid() const;
+  long read(char* buffer, size_t size);
+
+ private:
+  int file_descriptor;
+  bz_stream stream;
+  std::vector<char> compressed;
+  bool valid;
+  bool input_finished;
+  bool finished;
+  // The decoder has been given input since the last stream ended.
+  bool in_stream;
+
+};
+
+Bzip2Source::Bzip2Source(int file_descriptor) : file_descriptor(file_descriptor), stream(),
+    compressed(1 << 17), input_finished(false), finished(false), in_stream(false) {
+  valid = BZ2_bzDecompressInit(&stream, 0, 0) == BZ_OK;
+}
+
+Bzip2Source::~Bzip2Source() {
+  if (valid) {
+    BZ2_bzDecompressEnd(&stream);
+  }
+  close(file_descriptor);
+}
+
+bool Bzip2Source::isValid() const {
+  return valid;
+}
+
+long Bzip2Source::read(char* buffer, size_t size) {
+  if (finished) {
+    return 0;
+  }
+  stream.next_out = buffer;
+  stream.avail_out = size;
+  while (stream.avail_out == size) {
+    if (stream.avail_in == 0) {
+      if (input_finished) {
+        if (in_stream) {
+          return -1; // Truncated stream.
+        }
+        finished = true;
+        break;
+      }
+      auto bytes_read = ::read(file_descriptor, compressed.data(), compressed.size());
+      if (bytes_read < 0) {
+        return -1;
+      }
+      input_finished = (bytes_read == 0);
+      stream.next_in = compressed.data();
+      stream.avail_in = bytes_read;
+      continue;
+    }
+    in_stream = true;
+    auto result = BZ2_bzDecompress(&stream);
+    if (result == BZ_STREAM_END) {
+      // Restart the decoder for the next stream, the remaining input and the output buffer are kept.
+      BZ2_bzDecompressEnd(&stream);
+      valid = BZ2_bzDecompressInit(&stream, 0, 0) == BZ_OK;
+      if (!valid) {
+        return -1;
+      }
+      in_stream = false;
+    } else if (result != BZ_OK) {
+      // Also covers trailing data that does not start with the bzip2 magic.
+      return -1;
+    }
+  }
+  return size - stream.avail_out;
+}
+#endif
+
+InputFormat inputFormatFromName(const std::string& fname) {
+  auto hasSuffix = [&fname](const std::string& suffix) {
+    return fname.size() >= suffix.size() && fname.compare(fname.size() - suffix.size(), suffix.size(), suffix) == 0;
+  };
+  if (hasSuffix(".gz")) {
+    return InputFormat::Gzip;
+  } else if (hasSuffix(".xz") || hasSuffix(".lzma")) {
+    return InputFormat::Xz;
+  } else if (hasSuffix(".bz2")) {
+    return InputFormat::Bzip2;
+  }
+  return InputFormat::Plain;
+}
+
+bool isInputFormatSupported(InputFormat format) {
+  switch (format) {
+    case InputFormat::Xz:
+#ifdef PEDANT_WITH_LZMA
+      return true;
+#else
+      return false;
+#endif
+    case InputFormat::Bzip2:
+#ifdef PEDANT_WITH_BZIP2
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return true;
+  }
+}
+
+std::string inputFormatName(InputFormat format) {
+  switch (format) {
+    case InputFormat::Gzip:
+      return "gzip";
+    case InputFormat::Xz:
+      return "xz";
+    case InputFormat::Bzip2:
+      return "bzip2";
+    default:
+      return "plain";
+  }
+}
+
+std::unique_ptr<InputSource> openInputSource(const std::string& fname, InputFormat format) {
+  int file_descriptor = (fname == "-") ? dup(STDIN_FILENO) : open(fname.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    return nullptr;
+  }
+  switch (format) {
+#ifdef PEDANT_WITH_LZMA
+    case InputFormat::Xz: {
+      auto source = std::make_unique<XzSource>(file_descriptor);
+      if (!source->isValid()) {
+        return nullptr;
+      }
+      return source;
+    }
+#endif
+#ifdef PEDANT_WITH_BZIP2
+    case InputFormat::Bzip2: {
+      auto source = std::make_unique<Bzip2Source>(file_descriptor);
+      if (!source->isValid()) {
+        return nullptr;
+      }
+      return source;
+    }
+#endif
+    case InputFormat::Plain:
+    case InputFormat::Gzip: {
+      // zlib passes uncompressed data through unchanged.
+      gzFile file = gzdopen(file_descriptor, "rb");
+      if (file == nullptr) {
+        close(file_descriptor);
+        return nullptr;
+      }
+      return std::make_unique<GzipSource>(file);
+    }
+    default:
+      close(file_descriptor);
+      return nullptr;
+  }
+}
+
+}
@@ -0,0 +1,42 @@
+#ifndef PEDANT_INPUT_SOURCE_H_
+#define PEDANT_INPUT_SOURCE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace pedant {
+
+enum class InputFormat {Plain, Gzip, Xz, Bzip2};
+
+/**
+ * A sequential source of (decompressed) bytes.
+ **/
+class InputSource {
+
+ public:
+  virtual ~InputSource() = default;
+  /**
+   * Reads at most size bytes into buffer. Returns the number of bytes read, 0 at the end of the input
+   * and a negative value if an error occurred.
+   **/
+  virtual long read(char* buffer, size_t size) = 0;
+
+};
+
+/**
+ * Determines the format of a file from its extension (.gz, .xz, .lzma, .bz2).
+ **/
+InputFormat inputFormatFromName(const std::string& fname);
+bool isInputFormatSupported(InputFormat format);
+std::string inputFormatName(InputFormat format);
+
+/**
+ * Opens the given file for streaming decompression. "-" denotes the standard input, which may be plain or gzip-compressed.
+ * Returns nullptr if the file could not be opened.
+ **/
+std::unique_ptr<InputSource> openInputSource(const std::string& fname, InputFormat format);
+
+}
+
+#endif // PEDANT_INPUT_SOURCE_H_
@@ -0,0 +1,77 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mappedfile.h"
+
+namespace pedant {
+
+MappedFile::MappedFile() : mapping(nullptr), mapping_size(0), contents(nullptr), contents_size(0) {
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const std::string& fname) {
+  close();
+  int file_descriptor = ::open(fname.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    return false;
+  }
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) != 0 || S_ISDIR(file_status.st_mode)) {
+    ::close(file_descriptor);
+    return false;
+  }
+  if (S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+    void* region = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (region != MAP_FAILED) {
+      madvise(region, file_status.st_size, MADV_SEQUENTIAL);
+      mapping = region;
+      mapping_size = file_status.st_size;
+      contents = static_cast<const char*>(region);
+      contents_size = mapping_size;
+      ::close(file_descriptor);
+      return true;
+    }
+  }
+  bool success = readIntoBuffer(file_descriptor);
+  ::close(file_descriptor);
+  return success;
+}
+
+bool MappedFile::readIntoBuffer(int file_descriptor) {
+  constexpr size_t chunk_size = 1 << 16;
+  size_t used = 0;
+  while (true) {
+    buffer.resize(used + chunk_size);
+    ssize_t bytes_read = read(file_descriptor, buffer.data() + used, chunk_size);
+    if (bytes_read < 0) {
+      buffer.clear();
+      return false;
+    } else if (bytes_read == 0) {
+      break;
+    }
+    used += bytes_read;
+  }
+  buffer.resize(used);
+  contents = buffer.data();
+  contents_size = used;
+  return true;
+}
+
+void MappedFile::close() {
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+  }
+  buffer.clear();
+  buffer.shrink_to_fit();
+  contents = nullptr;
+  contents_size = 0;
+}
+
+}
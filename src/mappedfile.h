@@ -0,0 +1,52 @@
+#ifndef PEDANT_MAPPED_FILE_H_
+#define PEDANT_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pedant {
+
+/**
+ * Read-only view of the contents of a file.
+ * Regular files are memory-mapped, everything else (or a failing mmap) falls back to reading the file into a buffer.
+ **/
+class MappedFile {
+
+ public:
+  MappedFile();
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Opens the given file. Returns false if the file could not be opened.
+   **/
+  bool open(const std::string& fname);
+  void close();
+
+  const char* data() const;
+  size_t size() const;
+
+ private:
+  bool readIntoBuffer(int file_descriptor);
+
+  void* mapping;
+  size_t mapping_size;
+  std::vector<char> buffer;
+  const char* contents;
+  size_t contents_size;
+
+};
+
+inline const char* MappedFile::data() const {
+  return contents;
+}
+
+inline size_t MappedFile::size() const {
+  return contents_size;
+}
+
+}
+
+#endif // PEDANT_MAPPED_FILE_H_
@@ -22,6 +22,7 @@
 #include "preprocessor.h"
 #include "interrupt.h"
 #include "argumentconstraint.h"
+#include "formulasnapshot.h"
 
 
 static constexpr int VERSION_MAJOR = 2;
@@ -33,16 +34,19 @@ static const char USAGE[] =
 R"(Pedant
 Usage: 
   pedant [options] [FORMULA]
+FORMULA may be compressed (.gz, .xz, .bz2), use - to read it from the standard input.
 General Options:
   -h --help                     Print this message.
   -v --version                  Print the version number.
   --verbose=int                 Only has an effect in debug builds [default: 3]
 Solver Options:
   --rrs=bool                    Eliminiate dependencies with the RRS dependency scheme [default: true]
+  --rrs-threads=int             Number of threads for the RRS dependency scheme, 0 uses all hardware threads [default: 1]
   --forall-reduction=bool       Apply forall reduction [default: true]
   --extended-dependencies=bool  Use extended dependencies [default: true]
   --dynamic-dependencies=bool   If all variables in the representation of a skolemfunction for e1
                                 occur in the extended dependencies of e2 then e2 may use e1 [default: true]
+  --dependency-bitsets=bool     Use bitsets for dependency inclusion tests if the formula is dense enough [default: false]
   --unates=bool                 Detect unate clauses [default: false]
   --definitions=bool            Compute definitions [default: true]
   --always-add-arbiter=bool     Add arbiters in each iteration [default: false]
@@ -52,11 +56,25 @@ Solver Options:
   --unate-limit=int             Set the conflict limit for unate clause detection. [default: 2000]
   --no-conflict-limit-unates    Disable the conflict limit for unates.                  
   --definition-limit=int        Set the conflict limit for definability checks. [default: 1000]
+  --definability-threads=int    Number of threads for the initial definability checks, 0 uses all hardware threads [default: 1]
+  --definability-budget=int     Time in milliseconds for the initial definability checks, 0 for a fixed schedule [default: 0]
+  --recheck-interval=int        Conflicts between re-checks of the variables left over by a budgeted definability check, 0 disables them [default: 100]
+  --recheck-budget=int          Time in milliseconds for one definability re-check [default: 20]
+  --background-definitions=bool Search for definitions in a background thread during the CEGIS loop [default: false]
+  --lean-definitions=bool       Use a definability encoding that keeps only one copy of the matrix,
+                                the cubes and race engines still need a second copy [default: false]
+  --definition-cache=bool       Reuse the results of earlier definability checks [default: false]
+  --definition-engine=VAL       Backend for extracting definitions (interpolation, cubes, race) [default: interpolation]
+  --race-budget=int             Time in milliseconds for cube enumeration in a race [default: 100]
+  --minimize-definitions=int    Optimize definition circuits with ABC (0: off, 1: strash, 2: +rewrite, 3: +balance, 4: +fraig) [default: 0]
+  --minimize-threshold=int      Minimal number of gates of a definition circuit to be optimized [default: 16]
 Conflict Extraction Options:
   --support-strat=VAL           Strategy for the conflict extraction (core, minsep) 
                                 core: Unsat core of falsifying assignment
                                 minsep: Based on MaxFlow [default: minsep]
   --replaceArbiters=bool       Try to replace arbiters with the associated existentials. [default: true]
+  --falsified-clauses=int       Number of falsified clauses whose support is computed, the smallest one is used (minsep only) [default: 1]
+  --counterexamples=int         Maximal number of counterexamples that are analyzed per arbiter assignment [default: 1]
 Background Sat Solver Options:  Supported Solvers (cadical, glucose)
   --sat-solver=VAL              Sets the default Sat solver [default: cadical]
   --arbitersolver=VAL           Set the SAT solver for the arbiter solver
@@ -74,6 +92,9 @@ Default Function Options:       Options for the construction of default function
   --maxValsPerNode=VAL          Maximal number of samples in a node in the default tree. 0 for using no limit [default: 20]
   --minValsPerNode=VAL          Minimal number of samples in a node in the default tree. Must not be larger than minValsPerNode [default: 5]
   --checkIntervall=VAL          Check after VAL new samples if a node shall be split. [default: 5]
+Snapshot Options:
+  --snapshot FILE               Load the preprocessed formula from FILE if FILE was written for the same input file
+                                and preprocessing options. Otherwise preprocess the formula and write it to FILE.
 Certificate Options:
   --cnf FILE                    Write a clausal model to FILE.
   --aag FILE                    Write an ASCII AIGER model to FILE.
@@ -87,6 +108,7 @@ namespace pedant {
 Configuration setConfigurations(std::map<std::string, docopt::value>& args);
 void checkConfiguration(Configuration& config);
 bool checkArguments(std::map<std::string, docopt::value>& args);
+InputFormula loadFormula(const std::string& filename, Configuration& config);
 
 int main(int argc, char* argv[]) {
   std::string version_info = "";
@@ -124,15 +146,11 @@ int main(int argc, char* argv[]) {
       break;
   }
 
-  DQDIMACSParser parser;
   try {
     signal(SIGABRT, InterruptHandler::interrupt);
     signal(SIGTERM, InterruptHandler::interrupt);
     signal(SIGINT, InterruptHandler::interrupt);
-    DQDIMACS input = parser.parseFormula(filename);
-    Preprocessor preprocessor(input, config);
-    InputFormula formula = preprocessor.preprocess();
-    
+    InputFormula formula = loadFormula(filename, config);
 
     auto solver = Solver(formula, config);
     int status = solver.solve();
@@ -153,6 +171,31 @@ int main(int argc, char* argv[]) {
   }
 }
 
+InputFormula loadFormula(const std::string& filename, Configuration& config) {
+  uint64_t source_checksum = 0;
+  uint64_t configuration_fingerprint = FormulaSnapshot::fingerprint(config);
+  if (config.use_snapshot) {
+    if (filename == "-" || !FormulaSnapshot::checksum(filename, source_checksum)) {
+      std::cerr << "Snapshots can only be used for formulas that are given as a file." << std::endl;
+      config.use_snapshot = false;
+    } else {
+      InputFormula formula;
+      if (FormulaSnapshot::read(config.snapshot_filename, source_checksum, configuration_fingerprint, formula)) {
+        std::cerr << "Loaded the preprocessed formula from " << config.snapshot_filename << "." << std::endl;
+        return formula;
+      }
+    }
+  }
+  DQDIMACSParser parser;
+  DQDIMACS input = parser.parseFormula(filename);
+  Preprocessor preprocessor(input, config);
+  InputFormula formula = preprocessor.preprocess();
+  if (config.use_snapshot && !FormulaSnapshot::write(config.snapshot_filename, formula, source_checksum, configuration_fingerprint)) {
+    std::cerr << "The snapshot " << config.snapshot_filename << " could not be written." << std::endl;
+  }
+  return formula;
+}
+
 bool checkArguments(std::map<std::string, docopt::value>& args) {
   vector<unique_ptr<ArgumentConstraint>> argument_constraints;
 
@@ -160,6 +203,7 @@ bool checkArguments(std::map<std::string, docopt::value>& args) {
   argument_constraints.push_back(make_unique<BoolConstraint>("--forall-reduction"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--extended-dependencies"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--dynamic-dependencies"));
+  argument_constraints.push_back(make_unique<BoolConstraint>("--dependency-bitsets"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--unates"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--definitions"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--always-add-arbiter"));
@@ -168,10 +212,23 @@ bool checkArguments(std::map<std::string, docopt::value>& args) {
   argument_constraints.push_back(make_unique<BoolConstraint>("--fcs-matrix"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--useExistentialsInDT"));
   argument_constraints.push_back(make_unique<BoolConstraint>("--replaceArbiters"));
+  argument_constraints.push_back(make_unique<BoolConstraint>("--background-definitions"));
+  argument_constraints.push_back(make_unique<BoolConstraint>("--lean-definitions"));
+  argument_constraints.push_back(make_unique<BoolConstraint>("--definition-cache"));
 
   argument_constraints.push_back(make_unique<IntRangeConstraint>(1, 3, "--verbose"));
   argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--unate-limit"));
   argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--definition-limit"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, INT_MAX, "--rrs-threads"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, INT_MAX, "--definability-threads"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, INT_MAX, "--definability-budget"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, INT_MAX, "--recheck-interval"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--recheck-budget"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--race-budget"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, 4, "--minimize-definitions"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(0, INT_MAX, "--minimize-threshold"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--falsified-clauses"));
+  argument_constraints.push_back(make_unique<IntRangeConstraint>(1, INT_MAX, "--counterexamples"));
   argument_constraints.push_back(make_unique<IntRangeConstraint>(INT_MIN, INT_MAX, "--seed"));
 
   std::vector<std::string> possible_solvers {"cadical","glucose"};
@@ -186,6 +243,9 @@ bool checkArguments(std::map<std::string, docopt::value>& args) {
   std::vector<std::string> support_startegies {"core", "minsep"};
   argument_constraints.push_back(make_unique<ListConstraint>(support_startegies, "--support-strat"));
 
+  std::vector<std::string> definition_engines {"interpolation", "cubes", "race"};
+  argument_constraints.push_back(make_unique<ListConstraint>(definition_engines, "--definition-engine"));
+
   std::vector<std::string> default_startegies {"values", "functions"};
   argument_constraints.push_back(make_unique<ListConstraint>(default_startegies, "--default-strat"));
 
@@ -251,12 +311,18 @@ Configuration setConfigurations(std::map<std::string, docopt::value>& args) {
   } else {
     config.extract_aig_model=false;
   }
+  if (args["--snapshot"]) {
+    config.use_snapshot=true;
+    config.snapshot_filename=args["--snapshot"].asString();
+  }
 
 
   config.apply_dependency_schemes = isTrue(args["--rrs"].asString());
+  config.rrs_threads = args["--rrs-threads"].asLong();
   config.apply_forall_reduction = isTrue(args["--forall-reduction"].asString());
   config.extended_dependencies = isTrue(args["--extended-dependencies"].asString());
   config.dynamic_dependencies = isTrue(args["--dynamic-dependencies"].asString());
+  config.dependency_bitsets = isTrue(args["--dependency-bitsets"].asString());
   config.always_add_arbiter_clause = isTrue(args["--always-add-arbiter"].asString());
   config.definitions = isTrue(args["--definitions"].asString());
   config.check_for_unates = isTrue(args["--unates"].asString());
@@ -266,6 +332,16 @@ Configuration setConfigurations(std::map<std::string, docopt::value>& args) {
 
   config.verbosity = args["--verbose"].asLong();
   config.conflict_limit_definability_checker = args["--definition-limit"].asLong();
+  config.definability_threads = args["--definability-threads"].asLong();
+  config.definability_time_budget = args["--definability-budget"].asLong();
+  config.definability_recheck_interval = args["--recheck-interval"].asLong();
+  config.definability_recheck_budget = args["--recheck-budget"].asLong();
+  config.background_definability = isTrue(args["--background-definitions"].asString());
+  config.lean_definability_encoding = isTrue(args["--lean-definitions"].asString());
+  config.definability_cache = isTrue(args["--definition-cache"].asString());
+  config.definition_race_budget = args["--race-budget"].asLong();
+  config.definition_minimization = args["--minimize-definitions"].asLong();
+  config.definition_minimization_threshold = args["--minimize-threshold"].asLong();
   config.conflict_limit_unate_solver = args["--unate-limit"].asLong();
 
   if((args["--no-conflict-limit-unates"].asBool())) {
@@ -303,6 +379,17 @@ Configuration setConfigurations(std::map<std::string, docopt::value>& args) {
   } else if (supp_strat.compare("minsep")==0) {
     config.sup_strat = ConflictStrategy::MinSeparator;
   }
+  config.falsified_clause_candidates = args["--falsified-clauses"].asLong();
+  config.counterexamples_per_iteration = args["--counterexamples"].asLong();
+
+  std::string definition_engine = args["--definition-engine"].asString();
+  if (definition_engine.compare("interpolation")==0) {
+    config.definition_engine = DefinitionEngine::Interpolation;
+  } else if (definition_engine.compare("cubes")==0) {
+    config.definition_engine = DefinitionEngine::CubeEnumeration;
+  } else if (definition_engine.compare("race")==0) {
+    config.definition_engine = DefinitionEngine::Race;
+  }
 
   std::string def_strat = args["--default-strat"].asString();
   if (def_strat.compare("values")==0) {
@@ -54,8 +54,10 @@ InputFormula Preprocessor::preprocess() {
     std::sort(formula.getExistentials().begin() + result.start_index_innermost_existentials, formula.getExistentials().begin() + result.end_index_innermost_existentials);
   } else {
     auto deps = dependencies.getDependencies();
-    result.dependencies = deps;
-    result.extended_dependenices = std::move(deps);
+    for (const auto& [var, var_dependencies] : deps) {
+      result.extended_dependenices.set(var, var_dependencies);
+    }
+    result.dependencies = std::move(deps);
   }
 
 
@@ -83,9 +85,9 @@ InputFormula Preprocessor::preprocess() {
     for (auto& [variable, dependencies] : result.dependencies) {
       dependency_map_set[variable] = std::unordered_set<int>(dependencies.begin(), dependencies.end());
     }
-    for (auto& clause: result.matrix) {
+    result.matrix.reduceClauses([&](Clause& clause) {
       applyForallReduction(clause, universal_set, innermost_existentials,  dependency_map_set);
-    }
+    });
   }
   
   result.setMaxVariable();
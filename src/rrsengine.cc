@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <limits>
+
+#include "rrsengine.h"
+
+namespace pedant {
+
+RRSEngine::RRSEngine(const ClauseDatabase& matrix, int max_variable) : variable_index(max_variable + 1, -1), number_of_variables(0) {
+  for (int l: matrix.getLiterals()) {
+    auto v = abs(l);
+    if (static_cast<size_t>(v) >= variable_index.size()) {
+      variable_index.resize(v + 1, -1);
+    }
+    if (variable_index[v] == -1) {
+      variable_index[v] = number_of_variables++;
+    }
+  }
+
+  clause_offsets = matrix.getOffsets();
+  clause_literals.reserve(matrix.numberOfLiterals());
+  occurrence_offsets.assign(2 * number_of_variables + 1, 0);
+  for (int l: matrix.getLiterals()) {
+    auto c = code(variable_index[abs(l)], l < 0);
+    clause_literals.push_back(c);
+    occurrence_offsets[c + 1]++;
+  }
+  for (size_t i = 1; i < occurrence_offsets.size(); i++) {
+    occurrence_offsets[i] += occurrence_offsets[i - 1];
+  }
+  occurrences.resize(clause_literals.size());
+  std::vector<size_t> next_position(occurrence_offsets.begin(), occurrence_offsets.end() - 1);
+  for (size_t c = 0; c + 1 < clause_offsets.size(); c++) {
+    for (size_t i = clause_offsets[c]; i < clause_offsets[c + 1]; i++) {
+      occurrences[next_position[clause_literals[i]]++] = c;
+    }
+  }
+}
+
+RRSEngine::SearchState RRSEngine::createSearchState() const {
+  SearchState state;
+  state.considered.assign(number_of_variables, 0);
+  state.marked_positive.assign(2 * number_of_variables, 0);
+  state.marked_negative.assign(2 * number_of_variables, 0);
+  return state;
+}
+
+void RRSEngine::nextEpoch(SearchState& state) const {
+  if (state.epoch == std::numeric_limits<uint32_t>::max()) {
+    std::fill(state.considered.begin(), state.considered.end(), 0);
+    std::fill(state.marked_positive.begin(), state.marked_positive.end(), 0);
+    std::fill(state.marked_negative.begin(), state.marked_negative.end(), 0);
+    state.epoch = 0;
+  }
+  state.epoch++;
+}
+
+void RRSEngine::consider(int variable, SearchState& state) const {
+  if (static_cast<size_t>(variable) < variable_index.size() && variable_index[variable] != -1) {
+    state.considered[variable_index[variable]] = state.epoch;
+  }
+}
+
+/**
+ * Marks all literals reachable from literal_to_start. A literal l is expanded by visiting the literals of the
+ * clauses containing the complement of l, apart from the complement itself.
+ * The literals are marked when they are pushed, thus each literal is put onto the stack at most once.
+ **/
+void RRSEngine::searchPaths(uint32_t literal_to_start, std::vector<uint32_t>& marked, SearchState& state) const {
+  const auto epoch = state.epoch;
+  if (state.considered[literal_to_start >> 1] != epoch || marked[literal_to_start] == epoch) {
+    return;
+  }
+  auto& stack = state.stack;
+  stack.clear();
+  marked[literal_to_start] = epoch;
+  stack.push_back(literal_to_start);
+  while (!stack.empty()) {
+    auto l = stack.back();
+    stack.pop_back();
+    auto complement_l = complement(l);
+    for (size_t i = occurrence_offsets[complement_l]; i < occurrence_offsets[complement_l + 1]; i++) {
+      auto clause_index = occurrences[i];
+      for (size_t j = clause_offsets[clause_index]; j < clause_offsets[clause_index + 1]; j++) {
+        auto next = clause_literals[j];
+        if (next != complement_l && state.considered[next >> 1] == epoch && marked[next] != epoch) {
+          marked[next] = epoch;
+          stack.push_back(next);
+        }
+      }
+    }
+  }
+}
+
+void RRSEngine::findDependentVariables(int universal, const std::vector<int>& candidates, const std::vector<int>& passable,
+    SearchState& state, std::vector<int>& result) const {
+  if (static_cast<size_t>(universal) >= variable_index.size() || variable_index[universal] == -1) {
+    // A universal that does not occur in the matrix is not connected to any variable.
+    return;
+  }
+  nextEpoch(state);
+  for (int e: candidates) {
+    consider(e, state);
+  }
+  for (int e: passable) {
+    consider(e, state);
+  }
+  consider(universal, state);
+
+  uint32_t universal_index = variable_index[universal];
+  auto positive_universal = code(universal_index, false);
+  auto negative_universal = code(universal_index, true);
+  state.marked_positive[negative_universal] = state.epoch;
+  state.marked_negative[positive_universal] = state.epoch;
+  searchPaths(positive_universal, state.marked_positive, state);
+  searchPaths(negative_universal, state.marked_negative, state);
+
+  for (int e: candidates) {
+    if (static_cast<size_t>(e) >= variable_index.size() || variable_index[e] == -1) {
+      continue;
+    }
+    uint32_t e_index = variable_index[e];
+    auto positive_e = code(e_index, false);
+    auto negative_e = code(e_index, true);
+    //There is a RRS path
+    if ((state.marked_positive[positive_e] == state.epoch && state.marked_negative[negative_e] == state.epoch) ||
+        (state.marked_positive[negative_e] == state.epoch && state.marked_negative[positive_e] == state.epoch)) {
+      result.push_back(e);
+    }
+  }
+}
+
+}
@@ -0,0 +1,77 @@
+#ifndef PEDANT_RRSENGINE_H_
+#define PEDANT_RRSENGINE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "clausedatabase.h"
+
+namespace pedant {
+
+/**
+ * Resolution path search for the reflexive resolution path dependency scheme.
+ * The variables of the matrix are renumbered to 0,...,n-1 and literals are encoded as 2*index+sign, so that
+ * the occurrence lists and the marks of a search are stored in flat arrays whose size only depends on the number
+ * of variables that actually occur in the matrix.
+ **/
+class RRSEngine {
+
+ public:
+  /**
+   * Scratch space of a search. Marks are stamped with the current epoch, thus they do not have to be reset
+   * between two searches. Each thread has to use its own state.
+   **/
+  class SearchState {
+    friend class RRSEngine;
+   private:
+    uint32_t epoch = 0;
+    std::vector<uint32_t> considered;
+    std::vector<uint32_t> marked_positive;
+    std::vector<uint32_t> marked_negative;
+    std::vector<uint32_t> stack;
+  };
+
+  RRSEngine(const ClauseDatabase& matrix, int max_variable);
+
+  SearchState createSearchState() const;
+
+  /**
+   * Adds the variables in candidates that are connected to the universal by a pair of resolution paths to result.
+   * Only paths through the universal, the candidates and the variables in passable are taken into account.
+   **/
+  void findDependentVariables(int universal, const std::vector<int>& candidates, const std::vector<int>& passable,
+      SearchState& state, std::vector<int>& result) const;
+
+ private:
+  void nextEpoch(SearchState& state) const;
+  void consider(int variable, SearchState& state) const;
+  void searchPaths(uint32_t literal_to_start, std::vector<uint32_t>& marked, SearchState& state) const;
+
+  static uint32_t code(uint32_t index, bool negated);
+  static uint32_t complement(uint32_t code);
+
+  // Index of each variable of the matrix, -1 for variables that do not occur.
+  std::vector<int> variable_index;
+  size_t number_of_variables;
+
+  // Clause c consists of the encoded literals clause_literals[clause_offsets[c]],...,clause_literals[clause_offsets[c+1]-1].
+  std::vector<uint32_t> clause_literals;
+  std::vector<size_t> clause_offsets;
+
+  // The clauses containing the encoded literal l are occurrences[occurrence_offsets[l]],...,occurrences[occurrence_offsets[l+1]-1].
+  std::vector<uint32_t> occurrences;
+  std::vector<size_t> occurrence_offsets;
+
+};
+
+inline uint32_t RRSEngine::code(uint32_t index, bool negated) {
+  return 2 * index + negated;
+}
+
+inline uint32_t RRSEngine::complement(uint32_t code) {
+  return code ^ 1;
+}
+
+}
+
+#endif // PEDANT_RRSENGINE_H_
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <tuple>
 
 #include <assert.h>
 #include "utils.h"
@@ -13,7 +15,7 @@ SimpleValidityChecker::SimpleValidityChecker(
     const std::vector<int>& existentials,
     const std::vector<int>& universal_variables,
     const DependencyContainer& dependencies,
-    std::vector<Clause>& matrix, 
+    const ClauseDatabase& matrix, 
     int& last_used_variable,
     SkolemContainer& skolem_container, SolverData& shared_data, const Configuration& config): 
     existential_variables(existentials), universal_variables(universal_variables), matrix(matrix), last_used_variable(last_used_variable), 
@@ -34,7 +36,10 @@ SimpleValidityChecker::SimpleValidityChecker(
     selectors.push_back(selector);
   }
   auto [matrix_negated, clause_variables] = negateFormula(matrix, last_used_variable);
-  clause_satisfied_variables = clause_variables;
+  if (!clause_variables.empty()) {
+    first_clause_satisfied_variable = clause_variables.front();
+    last_clause_satisfied_variable = clause_variables.back();
+  }
   validity_check_solver->appendFormula(matrix_negated);
   DLOG(trace) << "Negated matrix: " << matrix_negated << std::endl;
   // Compute existential and universal dependencies.
@@ -44,7 +49,7 @@ SimpleValidityChecker::SimpleValidityChecker(
     supporttracker.setAlias(variable, variable);
     supporttracker.setAlias(-variable, -variable);
   }
-  supporttracker.setSatSolver(validity_check_solver);
+  supporttracker.setModel(validity_check_model);
 }
 
 bool SimpleValidityChecker::checkArbiterAssignment(std::vector<int>& arbiter_assignment) {
@@ -52,8 +57,10 @@ bool SimpleValidityChecker::checkArbiterAssignment(std::vector<int>& arbiter_ass
   validity_check_solver->assume(arbiter_assignment);
   validity_check_solver->assume(selectors);
   auto solver_result = validity_check_solver->solve();
+  validity_check_failed = (solver_result == 10);
   if (solver_result == 10) {
     DLOG(trace) << "Validity check failed." << std::endl;
+    validity_check_solver->getModel(validity_check_model);
     setFailingAssignments(arbiter_assignment);
     DLOG(trace) << "Falsifying universal assignment: " << failing_universal_assignment << std::endl
                 << "Falsifying existential assignment: " << failing_existential_assignment << std::endl;
@@ -69,6 +76,39 @@ bool SimpleValidityChecker::checkArbiterAssignment(std::vector<int>& arbiter_ass
   }
 }
 
+bool SimpleValidityChecker::findAnotherCounterexample(const std::vector<int>& arbiter_assignment, const std::vector<int>& universal_assignment) {
+  // A conflict without universals holds for all universal assignments.
+  if (!validity_check_failed || universal_assignment.empty()) {
+    return false;
+  }
+  if (blocking_selector == 0) {
+    blocking_selector = ++last_used_variable;
+  }
+  Clause blocking_clause = universal_assignment;
+  negateEach(blocking_clause);
+  blocking_clause.push_back(-blocking_selector);
+  DLOG(trace) << "Adding blocking clause to validity check solver: " << blocking_clause << std::endl;
+  validity_check_solver->addClause(blocking_clause);
+  validity_check_solver->assume(skolem_container.validityCheckAssumptions());
+  validity_check_solver->assume(arbiter_assignment);
+  validity_check_solver->assume(selectors);
+  validity_check_solver->assume({ blocking_selector });
+  if (validity_check_solver->solve() != 10) {
+    return false;
+  }
+  validity_check_solver->getModel(validity_check_model);
+  setFailingAssignments(arbiter_assignment);
+  DLOG(trace) << "Further falsifying universal assignment: " << failing_universal_assignment << std::endl;
+  return true;
+}
+
+void SimpleValidityChecker::releaseBlockingClauses() {
+  if (blocking_selector != 0) {
+    validity_check_solver->addClause({ -blocking_selector });
+    blocking_selector = 0;
+  }
+}
+
 void SimpleValidityChecker::setDefined(int variable) {
   DLOG(trace) << "Removing " << variable << " from undefined variables in validity checker." << std::endl;
   existential_variables.erase(std::find(existential_variables.begin(), existential_variables.end(), variable));
@@ -99,9 +139,9 @@ std::tuple<Clause, Clause, Clause, Clause, Clause> SimpleValidityChecker::getCon
 }
 
 
-void SimpleValidityChecker::setFailingAssignments(std::vector<int>& arbiter_assignment) {
-  full_universal_assignment = validity_check_solver->getValues(universal_variables);
-  full_existential_assignment = validity_check_solver->getValues(existential_variables);
+void SimpleValidityChecker::setFailingAssignments(const std::vector<int>& arbiter_assignment) {
+  full_universal_assignment = validity_check_model.getValues(universal_variables);
+  full_existential_assignment = validity_check_model.getValues(existential_variables);
   if (config.sup_strat == Core) {
     failing_universal_assignment = full_universal_assignment;
     failing_existential_assignment = full_existential_assignment;
@@ -109,16 +149,51 @@ void SimpleValidityChecker::setFailingAssignments(std::vector<int>& arbiter_assi
     return;
   }
   // Restrict to variables relevant for a clause in the matrix that is falsified.
-  auto clause_satisfied_variables_assignment = validity_check_solver->getValues(clause_satisfied_variables);
-  int i;
-  for (i = 0; i < clause_satisfied_variables_assignment.size() && clause_satisfied_variables_assignment[i] > 0; i++);
-  assert(i < clause_satisfied_variables_assignment.size());
-  Clause& falsified_clause = matrix[i];
-  int forced_variable = supporttracker.getForcedSource(falsified_clause);
-  auto [existential_support, universal_support, arbiter_support] = supporttracker.computeSupport(falsified_clause, forced_variable);
-  failing_existential_assignment = validity_check_solver->getValues(existential_support);
-  failing_universal_assignment = validity_check_solver->getValues(universal_support);
-  failing_arbiter_assignment = validity_check_solver->getValues(arbiter_support);
+  // If several clauses are falsified, the one with the smallest support yields the most general conflict.
+  auto falsified_clauses = getFalsifiedClauses(config.falsified_clause_candidates);
+  assert(!falsified_clauses.empty());
+  std::vector<int> existential_support, universal_support, arbiter_support;
+  size_t smallest_support = std::numeric_limits<size_t>::max();
+  // With several candidates, the conflict graph is only logged for the support that is used.
+  bool single_candidate = (falsified_clauses.size() == 1);
+  size_t used_clause = falsified_clauses.front();
+  int used_forced_variable = 0;
+  for (auto i: falsified_clauses) {
+    Clause falsified_clause = matrix[i].toClause();
+    int forced_variable = supporttracker.getForcedSource(falsified_clause);
+    auto support = supporttracker.computeSupport(falsified_clause, forced_variable, false, single_candidate);
+    auto support_size = std::get<0>(support).size() + std::get<1>(support).size() + std::get<2>(support).size();
+    if (support_size < smallest_support) {
+      smallest_support = support_size;
+      used_clause = i;
+      used_forced_variable = forced_variable;
+      std::tie(existential_support, universal_support, arbiter_support) = std::move(support);
+    }
+  }
+  if (!single_candidate && config.log_conflict_graphs) {
+    supporttracker.computeSupport(matrix[used_clause].toClause(), used_forced_variable);
+  }
+  failing_existential_assignment = validity_check_model.getValues(existential_support);
+  failing_universal_assignment = validity_check_model.getValues(universal_support);
+  failing_arbiter_assignment = validity_check_model.getValues(arbiter_support);
+}
+
+/**
+ * Returns the indices of up to max_clauses matrix clauses that are falsified by the model of the last validity check.
+ * Only the clause indicators are read from the solver, at most one value per matrix clause.
+ **/
+std::vector<size_t> SimpleValidityChecker::getFalsifiedClauses(size_t max_clauses) const {
+  std::vector<size_t> falsified_clauses;
+  int variable = first_clause_satisfied_variable;
+  while (falsified_clauses.size() < max_clauses && variable <= last_clause_satisfied_variable) {
+    variable = validity_check_model.findFalse(variable, last_clause_satisfied_variable);
+    if (variable == 0) {
+      break;
+    }
+    falsified_clauses.push_back(variable - first_clause_satisfied_variable);
+    variable++;
+  }
+  return falsified_clauses;
 }
 
 void SimpleValidityChecker::minimizeAssumptions(std::vector<int>& assumptions_to_minimize, std::vector<int>& assumptions_to_keep, std::vector<int>& other_assumptions_to_keep) {
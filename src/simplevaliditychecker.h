@@ -29,7 +29,7 @@ class SimpleValidityChecker {
   SimpleValidityChecker(const std::vector<int>& existential_variables,
                         const std::vector<int>& universal_variables,
                         const DependencyContainer& dependencies,
-                        std::vector<Clause>& matrix,
+                        const ClauseDatabase& matrix,
                         int& last_used_variable,
                         SkolemContainer& skolem_container, SolverData& shared_data, const Configuration& config);
   bool checkArbiterAssignment(std::vector<int>& arbiter_assignment);
@@ -37,29 +37,45 @@ class SimpleValidityChecker {
   void addClauseValidityCheck(int variable, Clause& clause);
   void addClauseConflictExtraction(Clause& clause);
   std::tuple<Clause, Clause, Clause, Clause, Clause> getConflict();
+  /**
+   * Searches for a further counterexample for the arbiter assignment of the last failed validity check that does not
+   * extend universal_assignment, which is excluded by a blocking clause. If one is found, it can be retrieved with getConflict.
+   * Only applicable if the last check failed due to the validity check, not the consistency check.
+   * The blocking clauses are active until releaseBlockingClauses is called.
+   **/
+  bool findAnotherCounterexample(const std::vector<int>& arbiter_assignment, const std::vector<int>& universal_assignment);
+  void releaseBlockingClauses();
   std::vector<int> getExistentialResponse(const std::vector<int>& universal_assignment, const std::vector<int>& arbiter_assignment);
   void setNoForcingClauseActiveVariable(int existential_variable, int no_forcing_clause_active_variable);
   void addArbiterVariable(int arbiter_variable);
   void addDefiningClause(int variable, const Clause& defining_clause, int activity_variable);
 
  private:
-  void setFailingAssignments(std::vector<int>& arbiter_assignment);
+  void setFailingAssignments(const std::vector<int>& arbiter_assignment);
+  std::vector<size_t> getFalsifiedClauses(size_t max_clauses) const;
   bool hasConflict(const std::vector<int>& existential_assignment, const std::vector<int>& universal_assignment, const std::vector<int>& arbiter_assignment, int conflict_limit=0);
   void minimizeAssumptions(std::vector<int>& assumptions_to_minimize, std::vector<int>& assumptions_to_keep, std::vector<int>& other_assumptions_to_keep);
   int& selector(int variable);
   std::tuple<std::unordered_set<int>, std::unordered_set<int>> getActiveSupport(int variable);
 
   std::vector<int> selectors;
-  std::vector<int> clause_satisfied_variables;
+  // Clause i of the matrix is satisfied iff first_clause_satisfied_variable + i is true, the variables are consecutive.
+  int first_clause_satisfied_variable = 0;
+  int last_clause_satisfied_variable = -1;
   std::unordered_map<int, int> variable_to_selector_index;
   std::vector<int> existential_variables;
   const std::vector<int>& universal_variables;
   std::vector<int> failing_existential_assignment, failing_universal_assignment, failing_arbiter_assignment;
   std::vector<int> full_universal_assignment;
   std::vector<int> full_existential_assignment;
-  std::vector<Clause>& matrix;
+  const ClauseDatabase& matrix;
   int& last_used_variable;
   std::shared_ptr<SatSolver> validity_check_solver;
+  // Model of the last failed validity check, read by setFailingAssignments and the support tracker.
+  ModelSnapshot validity_check_model;
+  bool validity_check_failed = false;
+  // Activates the blocking clauses added by findAnotherCounterexample, 0 if there are none.
+  int blocking_selector = 0;
   std::shared_ptr<SatSolver> conflict_extraction_solver;
   SkolemContainer& skolem_container;
   SupportTracker supporttracker;
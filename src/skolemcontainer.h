@@ -28,18 +28,6 @@ namespace pedant {
 
 class SimpleValidityChecker; // Forward declaration.
 
-// https://stackoverflow.com/questions/20511347/a-good-hash-function-for-a-vector
-class IntVectorHasher {
- public:
-  std::size_t operator()(std::vector<int> const& vec) const {
-    std::size_t ret = 0;
-    for(auto& i : vec) {
-      ret ^= std::hash<int>()(i);
-    }
-    return ret;
-  }
-};
-
 class SkolemContainer {
 
  public:
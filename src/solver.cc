@@ -1,11 +1,14 @@
 #include "solver.h"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 
 #include <assert.h>
 
 #include "logging.h"
+#include "parallel.h"
 
 #include "solver_generator.h"
 
@@ -23,6 +26,7 @@ Solver::Solver( InputFormula& formula, Configuration& config) :
                 dependencies(config, std::move(formula.dependencies), std::move(formula.extended_dependenices), undefined_variables, universal_variables_set, universal_variables),
                 matrix(std::move(formula.matrix)), config(config), preprocessing_done(false), 
                 definabilitychecker(universal_variables, existential_variables, matrix, last_used_variable, config, false), 
+                circuitminimizer(this->config), 
                 variables_defined_by_universals(universal_variables.begin(), universal_variables.end()), 
                 validitychecker(existential_variables, universal_variables, 
                   dependencies,
@@ -60,7 +64,16 @@ int Solver::solve() {
     int iteration = 0;
     int unchecked_iterations = 0;
     
-    if (config.definitions) {
+    if (config.definitions && config.definability_time_budget > 0) {
+      definability_scheduler = std::make_unique<DefinabilityScheduler>(config.conflict_limit_definability_checker);
+      for (auto variable: undefined_variables) {
+        //We do not want to look again for definitions for variables where we previously did not find definitions
+        if (!config.ignore_innermost_existentials || !std::binary_search(innermost_existentials.begin(), innermost_existentials.end(), variable)) {
+          scheduleDefinabilityCheck(variable, false);
+        }
+      }
+      checkDefinedScheduled(std::chrono::milliseconds(config.definability_time_budget), arbiter_assignment, config.dynamic_dependencies);
+    } else if (config.definitions) {
       if (config.ignore_innermost_existentials && !innermost_existentials.empty()) {
         //We do not want to look again for definitions for variables where we previously did not find definitions
         std::set<int> to_check1;
@@ -73,6 +86,7 @@ int Solver::solve() {
         checkDefined(undefined_variables, arbiter_assignment, false, 1);
         checkDefined(undefined_variables, arbiter_assignment, true, config.conflict_limit_definability_checker);
       }
+      definability_replicas.clear();
     }
     if (config.check_for_unates) {
       checkUnates();
@@ -84,10 +98,16 @@ int Solver::solve() {
       forcingClausesFromMatrix();
     }
     preprocessing_done = true;
+    if (config.definitions && config.background_definability) {
+      definability_worker = std::make_unique<DefinabilityWorker>(definabilitychecker, last_used_variable, config);
+    }
     while (true) {
       if (InterruptHandler::interrupted(nullptr)) {
         throw InterruptedException();
       }
+      if (definability_worker) {
+        exchangeWithDefinabilityWorker();
+      }
       iteration++;
       if (iteration % 500 == 0) {
         std::cerr << "Iteration: " << iteration << std::endl;
@@ -105,12 +125,22 @@ int Solver::solve() {
         if (config.extract_aig_model) {
           skolemcontainer.writeModelAsAIGToFile(arbiter_assignment,config.aig_model_filename,true);
         }
+        definability_worker.reset();
         return 10;
       }
-      solver_stats.conflicts++;
-      auto [failing_existential_assignment, failing_universal_assignment, failing_arbiter_assignment, complete_universal_assignment, complete_existential_assignment] = validitychecker.getConflict();
-
-      if (analyzeConflict(failing_existential_assignment, failing_universal_assignment, failing_arbiter_assignment, complete_universal_assignment, complete_existential_assignment)) {
+      auto conflicts = getConflicts();
+      auto previous_conflicts = solver_stats.conflicts;
+      solver_stats.conflicts += conflicts.size();
+      if (definability_scheduler && config.definability_recheck_interval > 0
+          && solver_stats.conflicts / config.definability_recheck_interval != previous_conflicts / config.definability_recheck_interval) {
+        recheckDefinability();
+      }
+      // The arbiter assignment only has to be updated if an arbiter clause was added.
+      bool only_forcing_conflicts = true;
+      for (auto& [failing_existential_assignment, failing_universal_assignment, failing_arbiter_assignment, complete_universal_assignment, complete_existential_assignment]: conflicts) {
+        only_forcing_conflicts &= analyzeConflict(failing_existential_assignment, failing_universal_assignment, failing_arbiter_assignment, complete_universal_assignment, complete_existential_assignment);
+      }
+      if (only_forcing_conflicts) {
         unchecked_iterations++;
         if (unchecked_iterations % 600 == 0) {
           unchecked_iterations = 0;
@@ -119,10 +149,12 @@ int Solver::solve() {
         }
       }
       if (!findArbiterAssignment()) {
+        definability_worker.reset();
         return 20;
       }
     }
   } catch(InterruptedException) {
+    definability_worker.reset();
     return 0;
   }
 }
@@ -130,7 +162,7 @@ int Solver::solve() {
 void Solver::forcingClausesFromMatrix() {
   std::unordered_set<int> existential_variables_set(existential_variables.begin(), existential_variables.end());
   int found = 0;
-  for (const Clause& cl : matrix) {
+  for (auto cl : matrix) {
     DLOG(trace) << "Checking clause " << cl << " for forcing conflict." << std::endl;
     std::vector<int> existentials_in_clause;
     std::vector<int> universals_in_clause;
@@ -158,7 +190,32 @@ void Solver::forcingClausesFromMatrix() {
 }
 
 bool Solver::checkArbiterAssignment() {
-  return validitychecker.checkArbiterAssignment(arbiter_assignment);
+  auto start = std::chrono::steady_clock::now();
+  auto is_valid = validitychecker.checkArbiterAssignment(arbiter_assignment);
+  solver_stats.validity_check_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return is_valid;
+}
+
+/**
+ * Returns the conflict for the current arbiter assignment. If the validity check failed, up to config.counterexamples_per_iteration
+ * counterexamples are extracted, each one with a universal assignment that is not covered by the previous conflicts.
+ * All of them are analyzed before the arbiter solver is called again.
+ **/
+std::vector<Solver::Conflict> Solver::getConflicts() {
+  std::vector<Conflict> conflicts;
+  conflicts.push_back(validitychecker.getConflict());
+  while (conflicts.size() < static_cast<size_t>(config.counterexamples_per_iteration)) {
+    auto start = std::chrono::steady_clock::now();
+    auto found = validitychecker.findAnotherCounterexample(arbiter_assignment, std::get<1>(conflicts.back()));
+    solver_stats.validity_check_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!found) {
+      break;
+    }
+    conflicts.push_back(validitychecker.getConflict());
+    solver_stats.additional_counterexamples++;
+  }
+  validitychecker.releaseBlockingClauses();
+  return conflicts;
 }
 
 bool Solver::findArbiterAssignment() {
@@ -192,8 +249,11 @@ void Solver::addForcingClause(Clause& forcing_clause, bool reduced) {
   }
   if (reduced) {
     variables_recently_forced.insert(var(forcing_clause.back()));
-    definabilitychecker.addClause(forcing_clause);
+    addDefinabilityClause(forcing_clause);
     variables_to_check.insert(var(forcing_clause.back()));
+    if (definability_worker) {
+      variables_to_check_in_background.insert(var(forcing_clause.back()));
+    }
   }
   skolemcontainer.addForcingClause(forcing_clause, reduced);
 }
@@ -205,7 +265,15 @@ void Solver::addDefinition(int variable, std::vector<Clause>& definition, const
   } else {
     solver_stats.conditional_definitions++;
   }
-  skolemcontainer.addDefinition(variable, definition, definition_circuit, conflict, reduced);
+  const auto* circuit = &definition_circuit;
+  Circuit minimized_circuit;
+  if (config.definition_minimization > 0) {
+    minimized_circuit = definition_circuit;
+    if (circuitminimizer.minimize(variable, definition, minimized_circuit, last_used_variable)) {
+      circuit = &minimized_circuit;
+    }
+  }
+  skolemcontainer.addDefinition(variable, definition, *circuit, conflict, reduced);
   if (reduced) {
     // Add to definability checker.
     // Introduce auxiliary variable representing the conflict.
@@ -213,43 +281,86 @@ void Solver::addDefinition(int variable, std::vector<Clause>& definition, const
     auto activation_clause = conflict;
     negateEach(activation_clause);
     activation_clause.push_back(definition_active);
-    definabilitychecker.addClause(activation_clause);
+    addDefinabilityClause(activation_clause);
     for (auto& clause: definition) {
       clause.push_back(-definition_active);
-      definabilitychecker.addClause(clause);
+      addDefinabilityClause(clause);
       clause.pop_back();
     }
   }
 }
 
+void Solver::addDefinabilityClause(Clause& clause) {
+  definabilitychecker.addClause(clause);
+  if (definability_worker) {
+    definability_worker->addClause(clause);
+  }
+}
+
+/**
+ * Safe point of the CEGIS loop: hands the variables with new reduced forcing clauses to the background worker
+ * and adds the definitions it has found for variables that are still undefined.
+ **/
+void Solver::exchangeWithDefinabilityWorker() {
+  for (auto variable: variables_to_check_in_background) {
+    if (undefined_variables.find(variable) != undefined_variables.end()) {
+      definability_worker->check(variable, getDefiningVariables(variable));
+    }
+  }
+  variables_to_check_in_background.clear();
+  DefinabilityWorker::Result result;
+  while (definability_worker->pollResult(result)) {
+    if (undefined_variables.find(result.variable) == undefined_variables.end()) {
+      continue;
+    }
+    renameAuxiliaryVariables(result.definition, result.definition_circuit, result.first_auxiliary_variable, last_used_variable);
+    DLOG(trace) << "Background definition for variable " << result.variable << " added." << std::endl;
+    std::vector<int> conflict;
+    addDefinition(result.variable, result.definition, result.definition_circuit, conflict, false);
+    solver_stats.background_definitions++;
+  }
+}
+
 template<typename T> void Solver::checkDefined(T variables_to_check, const std::vector<int>& assumptions, bool use_extended_dependencies, int conflict_limit) {
   std::vector<int> found_defined;
   DLOG(trace) << "Checking with conflict limit " << conflict_limit << "." << std::endl;
   std::set<int> queue(variables_to_check.begin(), variables_to_check.end());
+  auto number_of_workers = numberOfWorkers(config.definability_threads);
   int i = 0;
   while (!queue.empty() && i < config.incremental_definability_max_iterations) {
     i++;
     std::set<int> new_queue;
-    for (auto variable: queue) {
-      std::vector<int> dependency_vector (dependencies.getExtendedDependencies(variable));
-      if (!config.extended_dependencies) {
-        const auto& deps = dependencies.getDependencies(variable);
-        dependency_vector.insert(dependency_vector.end(), deps.begin(), deps.end());
+    if (number_of_workers > 1 && queue.size() > 1) {
+      // The checks of one iteration are independent, the results are processed in the order of the variables afterwards.
+      std::vector<int> variables(queue.begin(), queue.end());
+      auto results = checkDefinedInParallel(variables, assumptions, conflict_limit, number_of_workers);
+      for (size_t j = 0; j < variables.size(); j++) {
+        auto variable = variables[j];
+        auto& result = results[j];
+        if (result.defined) {
+          found_defined.push_back(variable);
+          renameAuxiliaryVariables(result.definition, result.definition_circuit, result.first_auxiliary_variable, last_used_variable);
+          DLOG(trace) << "Definition found for variable " << variable << " under assignment " << result.conflict << std::endl;
+          addDefinition(variable, result.definition, result.definition_circuit, result.conflict, false);
+          if (config.dynamic_dependencies) {
+            scheduleDependencyUpdate(variable, getDefiningVariables(variable), result.conflict, result.definition, new_queue);
+          }
+        }
       }
-      auto [defined, conflict] = definabilitychecker.checkDefinability(dependency_vector, variable, assumptions, conflict_limit + 1);
-      if( defined) {
-        std::unordered_set<int> dependencies_set(dependency_vector.begin(), dependency_vector.end());
-        found_defined.push_back(variable);
-        auto definition = getDefinition(variable, dependency_vector, conflict);
-        if (config.dynamic_dependencies) {
-          auto support = restrictTo(getSupport(conflict, definition), dependencies_set);
-          std::set<int> support_set(support.begin(), support.end());
-          DLOG(trace) << "Support: " << support << std::endl;
-          new_queue.erase(variable);
-          updateDynamicDependencies(variable, support_set, new_queue);
+      std::cerr << "Iteration " << i << ": " << found_defined.size() << "/" << variables_to_check.size() << " found defined with conflict limit " << conflict_limit << ". \r";
+    } else {
+      for (auto variable: queue) {
+        auto dependency_vector = getDefiningVariables(variable);
+        auto [defined, conflict] = definabilitychecker.checkDefinability(dependency_vector, variable, assumptions, conflict_limit + 1);
+        if( defined) {
+          found_defined.push_back(variable);
+          auto definition = getDefinition(variable, dependency_vector, conflict);
+          if (config.dynamic_dependencies) {
+            scheduleDependencyUpdate(variable, dependency_vector, conflict, definition, new_queue);
+          }
         }
+        std::cerr << "Iteration " << i << ": " << found_defined.size() << "/" << variables_to_check.size() << " found defined with conflict limit " << conflict_limit << " " << variable <<". \r";
       }
-      std::cerr << "Iteration " << i << ": " << found_defined.size() << "/" << variables_to_check.size() << " found defined with conflict limit " << conflict_limit << " " << variable <<". \r";
     }
     queue = new_queue;
     dependencies.performUpdate();
@@ -257,6 +368,147 @@ template<typename T> void Solver::checkDefined(T variables_to_check, const std::
   std::cerr << found_defined.size() << "/" << dependencies.getNofUndefined() << " found defined with conflict limit " << conflict_limit << " in " << i << " iterations." << std::endl;
 }
 
+/**
+ * Checks the variables from the definability scheduler until it is empty or the budget is used up.
+ * Failed checks are rescheduled with the next conflict limit, the variables that remain are re-checked during the CEGIS loop.
+ * Dependency updates are performed lazily, before the first check of a variable whose dependencies have grown.
+ **/
+void Solver::checkDefinedScheduled(std::chrono::milliseconds budget, const std::vector<int>& assumptions, bool update_dependencies) {
+  auto deadline = std::chrono::steady_clock::now() + budget;
+  size_t checked = 0;
+  size_t found_defined = 0;
+  std::set<int> updated_variables;
+  auto perform_update = [this, &updated_variables](int variable_to_check) {
+    dependencies.performUpdate();
+    for (auto v: updated_variables) {
+      if (v != variable_to_check && undefined_variables.find(v) != undefined_variables.end()) {
+        scheduleDefinabilityCheck(v, true);
+      }
+    }
+    updated_variables.clear();
+  };
+  while (!definability_scheduler->empty() && std::chrono::steady_clock::now() < deadline) {
+    auto [variable, conflict_limit] = definability_scheduler->next();
+    if (undefined_variables.find(variable) == undefined_variables.end()) {
+      continue;
+    }
+    if (updated_variables.find(variable) != updated_variables.end()) {
+      perform_update(variable);
+    }
+    checked++;
+    auto dependency_vector = getDefiningVariables(variable);
+    auto [defined, conflict] = definabilitychecker.checkDefinability(dependency_vector, variable, assumptions, conflict_limit + 1);
+    if (defined) {
+      found_defined++;
+      auto definition = getDefinition(variable, dependency_vector, conflict);
+      if (update_dependencies) {
+        scheduleDependencyUpdate(variable, dependency_vector, conflict, definition, updated_variables);
+      }
+    } else {
+      definability_scheduler->failed(variable);
+    }
+  }
+  if (!updated_variables.empty()) {
+    perform_update(0);
+  }
+  DLOG(trace) << found_defined << "/" << checked << " scheduled definability checks succeeded, " << definability_scheduler->size() << " variables left." << std::endl;
+  if (!preprocessing_done) {
+    std::cerr << found_defined << "/" << dependencies.getNofUndefined() << " found defined in " << checked << " scheduled checks, "
+              << definability_scheduler->size() << " variables left for re-checks." << std::endl;
+  }
+}
+
+/**
+ * Schedules a definability check of variable. The payoff of the check is estimated by the number of defining variables
+ * and the number of occurrences of the variable in the matrix.
+ **/
+void Solver::scheduleDefinabilityCheck(int variable, bool forget_failures) {
+  if (occurrences_in_matrix.empty()) {
+    for (const auto& clause: matrix) {
+      for (auto l: clause) {
+        occurrences_in_matrix[var(l)]++;
+      }
+    }
+  }
+  if (forget_failures) {
+    definability_scheduler->forgetFailures(variable);
+  }
+  auto it = occurrences_in_matrix.find(variable);
+  definability_scheduler->add(variable, getDefiningVariables(variable).size(), it == occurrences_in_matrix.end() ? 0 : it->second);
+}
+
+/**
+ * Spends a short time slice of the CEGIS loop on the variables left over by the definability preprocessing.
+ * Variables for which reduced forcing clauses have been learnt since the last re-check get their attempts back.
+ * The dependencies are not updated, since the default values and arbiters of the undefined variables rely on them.
+ **/
+void Solver::recheckDefinability() {
+  for (auto variable: variables_to_check) {
+    if (undefined_variables.find(variable) != undefined_variables.end()) {
+      scheduleDefinabilityCheck(variable, true);
+    }
+  }
+  variables_to_check.clear();
+  checkDefinedScheduled(std::chrono::milliseconds(config.definability_recheck_budget), std::vector<int>(), false);
+}
+
+/**
+ * Checks the definability of the variables with one replica of the definability checker per worker.
+ * The replicas are incremental and the outcome of a check under a conflict limit depends on the earlier checks of the replica.
+ * Thus, the variables are assigned to the replicas statically (variable j goes to replica j % number_of_workers) and each
+ * replica checks its variables in order, which makes the results independent of the scheduling of the threads.
+ * The replicas are created on the first call and kept for the following checks during preprocessing.
+ **/
+std::vector<Solver::DefinabilityResult> Solver::checkDefinedInParallel(const std::vector<int>& variables, const std::vector<int>& assumptions, int conflict_limit,
+    unsigned number_of_workers) {
+  while (definability_replicas.size() < number_of_workers) {
+    auto replica = std::make_unique<DefinabilityReplica>();
+    replica->last_used_variable = last_used_variable;
+    replica->first_auxiliary_variable = last_used_variable + 1;
+    replica->checker = std::make_unique<DefinabilityChecker>(definabilitychecker, replica->last_used_variable);
+    definability_replicas.push_back(std::move(replica));
+  }
+  std::vector<DefinabilityResult> results(variables.size());
+  // The dependency container caches dynamic dependencies, thus it must not be accessed concurrently.
+  std::mutex dependencies_mutex;
+  parallelFor(number_of_workers, number_of_workers, [&](size_t replica_index, unsigned) {
+    auto& replica = *definability_replicas[replica_index];
+    for (auto j = replica_index; j < variables.size(); j += number_of_workers) {
+      auto variable = variables[j];
+      std::vector<int> dependency_vector;
+      {
+        std::lock_guard<std::mutex> lock(dependencies_mutex);
+        dependency_vector = getDefiningVariables(variable);
+      }
+      auto& result = results[j];
+      std::tie(result.defined, result.conflict) = replica.checker->checkDefinability(dependency_vector, variable, assumptions, conflict_limit + 1);
+      if (result.defined) {
+        std::tie(result.definition, result.definition_circuit) = replica.checker->getDefinition(dependency_vector, variable, result.conflict);
+        result.first_auxiliary_variable = replica.first_auxiliary_variable;
+      }
+    }
+  });
+  return results;
+}
+
+std::vector<int> Solver::getDefiningVariables(int variable) const {
+  std::vector<int> dependency_vector (dependencies.getExtendedDependencies(variable));
+  if (!config.extended_dependencies) {
+    const auto& deps = dependencies.getDependencies(variable);
+    dependency_vector.insert(dependency_vector.end(), deps.begin(), deps.end());
+  }
+  return dependency_vector;
+}
+
+void Solver::scheduleDependencyUpdate(int variable, const std::vector<int>& dependency_vector, const std::vector<int>& conflict, const std::vector<Clause>& definition, std::set<int>& new_queue) {
+  std::unordered_set<int> dependencies_set(dependency_vector.begin(), dependency_vector.end());
+  auto support = restrictTo(getSupport(conflict, definition), dependencies_set);
+  std::set<int> support_set(support.begin(), support.end());
+  DLOG(trace) << "Support: " << support << std::endl;
+  new_queue.erase(variable);
+  updateDynamicDependencies(variable, support_set, new_queue);
+}
+
 std::vector<Clause> Solver::getDefinition(int variable, const std::vector<int>& dependencies, std::vector<int>& conflict) {
   DLOG(trace) << "Definition found for variable " << variable << " under assignment " << conflict << std::endl;
   auto [definition, definition_circuit] = definabilitychecker.getDefinition(dependencies, variable, conflict);
@@ -451,20 +703,23 @@ void Solver::processInnermostExistentials(int start_index_block, int end_index_b
   int nof_variables_to_check = end_index_block - start_index_block;
 
   std::set<int> to_preocess_set;
+  if (config.definitions) {
+    definabilitychecker.startNestedChecks(dependency_vector);
+  }
   for (auto variable : innermost_existentials) {
     if (undefined_variables.find(variable) == undefined_variables.end()) {
       continue; //we already added a definition for the variable
     }
     bool defined = config.definitions;
     if (config.definitions) {
-      auto [def, conflict] = definabilitychecker.checkDefinability(dependency_vector, variable, arbiter_assignment, config.conflict_limit_definability_checker + 1);
+      auto [def, conflict] = definabilitychecker.checkDefinabilityNested(variable, arbiter_assignment, config.conflict_limit_definability_checker + 1);
       defined = conflict.empty();
       defined = defined && def;
       if (defined) {
         definitions_found++;
         //Proceed similarly as in the method getDefinition
         DLOG(trace) << "Definition found for variable " << variable << std::endl;
-        auto [definition, definition_circuit] = definabilitychecker.getDefinition(dependency_vector, variable, conflict);
+        auto [definition, definition_circuit] = definabilitychecker.getDefinitionNested(variable, conflict);
         DLOG(trace) << "Definition size: " << definition.size() << " clauses." << std::endl;
         auto support = restrictTo(getSupport(conflict, definition), dependency_set);
         std::set<int> support_set(support.begin(), support.end());
@@ -488,10 +743,16 @@ void Solver::processInnermostExistentials(int start_index_block, int end_index_b
       dependency_vector.push_back(variable);
       dependency_set.insert(variable);
       dependency_set_2.insert(variable);
+      if (config.definitions) {
+        definabilitychecker.addNestedDefiningVariable(variable);
+      }
     }
     nof_processed++;
     std::cerr << "Processed: " << nof_processed << "out of " << nof_variables_to_check << " -- nof definitions: " << definitions_found << ".\r";
   }
+  if (config.definitions) {
+    definabilitychecker.endNestedChecks();
+  }
   dependencies.performUpdate();
 }
 
@@ -536,6 +797,19 @@ void Solver::printStatistics() {
   std::cerr << "Arbiters: " << solver_stats.arbiters_introduced << std::endl;
   std::cerr << "Arbiter clauses: " << solver_stats.arbiter_clauses << std::endl;
   std::cerr << "Unates: " << solver_stats.unates << std::endl;
+  if (config.background_definability) {
+    std::cerr << "Background definitions: " << solver_stats.background_definitions << std::endl;
+  }
+  if (config.counterexamples_per_iteration > 1) {
+    std::cerr << "Additional counterexamples: " << solver_stats.additional_counterexamples << std::endl;
+  }
+  std::cerr << "Time in validity checks: " << solver_stats.validity_check_seconds << "s" << std::endl;
+  if (config.definition_minimization > 0) {
+    const auto& minimization_stats = circuitminimizer.getStatistics();
+    std::cerr << "Minimized definitions: " << minimization_stats.minimized << " out of " << minimization_stats.calls << std::endl;
+    std::cerr << "Gates of minimized definitions: " << minimization_stats.gates_before << " -> " << minimization_stats.gates_after << std::endl;
+    std::cerr << "Time in definition minimization: " << minimization_stats.seconds << "s" << std::endl;
+  }
   if (solver_stats.conflicts) {
     std::cerr << "Average existential conflict size: " << double(solver_stats.existential_conflict_literals)/double(solver_stats.conflicts) << std::endl;
     std::cerr << "Average universal conflict size: " << double(solver_stats.universal_conflict_literals)/double(solver_stats.conflicts) << std::endl;
@@ -7,11 +7,15 @@
 #include <unordered_set>
 #include <tuple>
 #include <memory>
+#include <chrono>
 
 #include "solvertypes.h"
 #include "inputformula.h"
 #include "satsolver.h"
 #include "definabilitychecker.h"
+#include "definabilityscheduler.h"
+#include "definabilityworker.h"
+#include "circuitminimizer.h"
 #include "simplevaliditychecker.h"
 #include "skolemcontainer.h"
 #include "utils.h"
@@ -36,6 +40,8 @@ class Solver {
 
  private:
   bool checkArbiterAssignment();
+  using Conflict = std::tuple<Clause, Clause, Clause, Clause, Clause>;
+  std::vector<Conflict> getConflicts();
   bool analyzeConflict( const std::vector<int>& failed_existentials, const std::vector<int>& failed_universals, 
                         const std::vector<int>& failed_arbiters, const std::vector<int>& complete_universal_assignment, 
                         const std::vector<int>& complete_existential_assignment);
@@ -44,6 +50,11 @@ class Solver {
   std::tuple<Clause, bool> getForcingClause(int literal, const std::vector<int>& failed_existentials, const std::vector<int>& failed_universals, const std::vector<int>& failed_arbiters);
   void addForcingClause(Clause& forcing_clause, bool reduced);
   template<typename T> void checkDefined(T variables_to_check, const std::vector<int>& assumptions, bool use_extended_dependencies, int conflict_limit);
+  void checkDefinedScheduled(std::chrono::milliseconds budget, const std::vector<int>& assumptions, bool update_dependencies);
+  void scheduleDefinabilityCheck(int variable, bool forget_failures);
+  void recheckDefinability();
+  void addDefinabilityClause(Clause& clause);
+  void exchangeWithDefinabilityWorker();
   void addDefinition(int variable, std::vector<Clause>& definition, const std::vector<std::tuple<std::vector<int>,int>>& definition_circuit, std::vector<int>& conflict, bool reduced = false);
   std::tuple<int, bool> getArbiter(int existential_literal, const std::vector<int>& complete_universal_assignment, bool introduce_clauses);
   void checkUnates();
@@ -57,6 +68,26 @@ class Solver {
 
   std::vector<Clause> getDefinition(int var, const std::vector<int>& dependencies, std::vector<int>& conflict);
 
+  struct DefinabilityReplica {
+    int last_used_variable;
+    int first_auxiliary_variable;
+    std::unique_ptr<DefinabilityChecker> checker;
+  };
+
+  struct DefinabilityResult {
+    bool defined = false;
+    std::vector<int> conflict;
+    std::vector<Clause> definition;
+    std::vector<std::tuple<std::vector<int>,int>> definition_circuit;
+    int first_auxiliary_variable = 0;
+  };
+
+  std::vector<DefinabilityResult> checkDefinedInParallel(const std::vector<int>& variables, const std::vector<int>& assumptions, int conflict_limit,
+      unsigned number_of_workers);
+  std::vector<int> getDefiningVariables(int variable) const;
+  void scheduleDependencyUpdate(int variable, const std::vector<int>& dependency_vector, const std::vector<int>& conflict,
+      const std::vector<Clause>& definition, std::set<int>& new_queue);
+
   void updateDynamicDependencies(int var, std::set<int>& support_set, std::set<int>& updated_variables);
 
   void processInnermostExistentials(int start_index_block, int end_index_block);
@@ -71,21 +102,32 @@ class Solver {
   std::vector<int> innermost_existentials;
   std::vector<int> universal_variables;
   std::set<int> undefined_variables;
+  // Variables with new reduced forcing clauses. Each consumer has its own set: recheckDefinability uses variables_to_check,
+  // exchangeWithDefinabilityWorker uses variables_to_check_in_background.
   std::set<int> variables_to_check;
+  std::set<int> variables_to_check_in_background;
+  // Replicas of definabilitychecker for the parallel definability checks during preprocessing, see checkDefinedInParallel.
+  std::vector<std::unique_ptr<DefinabilityReplica>> definability_replicas;
+  // Only used with a time budget for the definability checks, holds the variables that are left for re-checks.
+  std::unique_ptr<DefinabilityScheduler> definability_scheduler;
+  std::unordered_map<int, size_t> occurrences_in_matrix;
   std::set<int> variables_recently_forced;
   std::unordered_set<int> universal_variables_set;
   std::shared_ptr<SatSolver> arbiter_solver;
   DependencyContainer dependencies;
-  std::vector<Clause> matrix;
+  ClauseDatabase matrix;
   DefinabilityChecker definabilitychecker;
   std::unique_ptr<UnateChecker> unate_checker;
   Configuration config;
+  CircuitMinimizer circuitminimizer;
   std::unordered_map<int, std::vector<int>> variable_to_forcing_common;
   SimpleValidityChecker validitychecker;
   SkolemContainer skolemcontainer;
   std::unordered_map<int, int> arbiter_counts;
   bool preprocessing_done;
   std::set<int> variables_defined_by_universals;
+  // Searches definitions for variables_to_check_in_background during the CEGIS loop, if enabled. Declared after the members it uses, so that it is stopped first.
+  std::unique_ptr<DefinabilityWorker> definability_worker;
 
   struct SolverStats {
     unsigned int arbiters_introduced = 0;
@@ -96,10 +138,15 @@ class Solver {
     unsigned int conditional_definitions = 0;
     unsigned int arbiter_clauses = 0;
     unsigned int defined = 0;
+    unsigned int background_definitions = 0;
     unsigned int unates = 0;
     unsigned int existential_conflict_literals = 0;
     unsigned int universal_conflict_literals = 0; 
     unsigned int arbiter_conflict_literals = 0;
+    // Counterexamples beyond the first one for an arbiter assignment, see Solver::getConflicts.
+    unsigned int additional_counterexamples = 0;
+    // Time spent in the validity checks, to assess the effect of the definition minimization.
+    double validity_check_seconds = 0;
   } solver_stats;
 
 };
@@ -80,16 +80,47 @@ int SupportTracker::getForcedSource(const std::vector<int>& literals, bool repla
 }
 
 
+void SupportTracker::addDefiningClause(int variable, const Clause& defining_clause, int activity_variable) {
+  auto node = getNode(variable);
+  // Classify the literals first, creating nodes for the existentials may invalidate references into nodes.
+  std::vector<int> universal_support, arbiter_support, existential_support;
+  for (int l: defining_clause) {
+    auto v = var(l);
+    auto it = variable_to_node.find(v);
+    if (it != variable_to_node.end() && nodes[it->second].no_forcing_clause_active_variable != 0) {
+      existential_support.push_back(v);
+    } else if (universal_variables.find(v) != universal_variables.end()) {
+      universal_support.push_back(v);
+    } else if (arbiter_variables.find(v) != arbiter_variables.end()) {
+      arbiter_support.push_back(v);
+    }
+  }
+  SupportRule rule;
+  rule.activity_variable = activity_variable;
+  rule.begin = support_entries.size();
+  for (auto v: universal_support) {
+    support_entries.push_back({v, 0});
+  }
+  rule.universals_end = support_entries.size();
+  for (auto v: arbiter_support) {
+    support_entries.push_back({v, 0});
+  }
+  rule.arbiters_end = support_entries.size();
+  for (auto v: existential_support) {
+    support_entries.push_back({v, variable_to_node.at(v)});
+  }
+  rule.end = support_entries.size();
+  nodes[node].rules.push_back(rules.size());
+  rules.push_back(rule);
+}
+
 std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::getActiveRuleSupport(int variable) {
-  auto activity_variables = variable_to_activity_variables[variable];
-  int i;
-  for (i = 0; i < activity_variables.size() && solver->val(activity_variables[i]) < 0; i++);
-  assert(i < activity_variables.size());
-  auto av = activity_variables[i];
-  auto& true_activity_variable_universal_support = activity_variable_to_universal_support[av];
-  auto& true_activity_variable_existential_support = activity_variable_to_existential_support[av];
-  auto& true_activity_variable_arbiter_support = activity_variable_to_arbiter_support[av];
-  return std::make_tuple(true_activity_variable_existential_support, true_activity_variable_universal_support, true_activity_variable_arbiter_support);
+  const auto& node_rules = nodes[getNode(variable)].rules;
+  size_t i;
+  for (i = 0; i < node_rules.size() && model->val(rules[node_rules[i]].activity_variable) < 0; i++);
+  assert(i < node_rules.size());
+  const auto& rule = rules[node_rules[i]];
+  return std::make_tuple(supportVariables(rule.arbiters_end, rule.end), supportVariables(rule.begin, rule.universals_end), supportVariables(rule.universals_end, rule.arbiters_end));
 }
 
 std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::getAssertingSupport(const std::vector<int>& literals, bool replace_initial) {
@@ -157,21 +188,22 @@ std::vector<int> SupportTracker::processSupport(int existential_variable, std::q
   }
   std::vector<int> connected;
   existential_variables_seen.insert(existential_variable);
-  auto activity_variables = variable_to_activity_variables[existential_variable];
-  for (auto av: activity_variables) {
-    if (solver->val(av) > 0) {
+  const auto& node = nodes[getNode(existential_variable)];
+  for (auto r: node.rules) {
+    const auto& rule = rules[r];
+    if (model->val(rule.activity_variable) > 0) {
       // Add universal and arbiter variables to support.
-      auto& true_activity_variable_universal_support = activity_variable_to_universal_support[av];
-      universals.insert(true_activity_variable_universal_support.begin(),true_activity_variable_universal_support.end());
-      connected.insert(connected.end(), true_activity_variable_universal_support.begin(),true_activity_variable_universal_support.end());
-
-      auto& true_activity_variable_arbiter_support = activity_variable_to_arbiter_support[av];
-      arbiters.insert(true_activity_variable_arbiter_support.begin(),true_activity_variable_arbiter_support.end());
-      connected.insert(connected.end(),true_activity_variable_arbiter_support.begin(),true_activity_variable_arbiter_support.end());
-
-      auto& true_activity_variable_existential_support = activity_variable_to_existential_support[av];
-      for (auto e: true_activity_variable_existential_support) {
-        if (solver->val(e) > 0 || getAlias(e) == e) {
+      for (auto i = rule.begin; i < rule.universals_end; i++) {
+        universals.insert(support_entries[i].variable);
+        connected.push_back(support_entries[i].variable);
+      }
+      for (auto i = rule.universals_end; i < rule.arbiters_end; i++) {
+        arbiters.insert(support_entries[i].variable);
+        connected.push_back(support_entries[i].variable);
+      }
+      for (auto i = rule.arbiters_end; i < rule.end; i++) {
+        auto [e, e_node] = support_entries[i];
+        if (model->val(e) > 0 || nodes[e_node].is_own_alias) {
           connected.push_back(e);
           if (existential_variables_seen.find(e) == existential_variables_seen.end()) {
             existentials_to_process.push(e);
@@ -209,7 +241,7 @@ std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker:
 }
 
 
-std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::getMinimalSeparator(const std::vector<int>& literals, int forced_variable, bool replace_initial) {
+std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::getMinimalSeparator(const std::vector<int>& literals, int forced_variable, bool replace_initial, bool log_graph) {
   assert (!replace_initial || (literals.size()==2 && literals[0] == -literals[1]));
   std::vector<int> vertices, source_vertices, sink_vertices;
   sink_vertices.reserve(literals.size());
@@ -319,7 +351,7 @@ std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker:
 
   sep.push_back(variable_to_include);
 
-  if (config.log_conflict_graphs) {
+  if (config.log_conflict_graphs && log_graph) {
     std::string filename;
     if (replace_initial) {
       filename = config.conflict_graph_log_dir + "cons_var_"+std::to_string(forced_variable)+"_idx_"+std::to_string(log_counter)+".dot";
@@ -327,6 +359,9 @@ std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker:
       filename = config.conflict_graph_log_dir + "val_var_"+std::to_string(forced_variable)+"_idx_"+std::to_string(log_counter)+".dot";
     }
     visualiseGraph(filename, literals, sep, forced_variable, replace_initial);
+    // The arguments of the separator computation, for replaying it with utils/separatorbenchmark.
+    filename.replace(filename.size() - 4, 4, ".sep");
+    GraphSeparator::saveInstance(filename, vertices, edges, source_vertices, sink_vertices, forbidden_variables, arbiter_vector);
     log_counter++;
   }
 
@@ -336,16 +371,20 @@ std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker:
 
 void SupportTracker::insertSupport(int existential_variable, std::vector<int>& existential_support, std::unordered_set<int>& existential_variables_seen, std::set<int>& universal_support, std::vector<int>& arbiter_support) {
   existential_variables_seen.insert(existential_variable);
-  auto activity_variables = variable_to_activity_variables[existential_variable];
-  for (auto av: activity_variables) {
-    if (solver->val(av) > 0) {
+  const auto& node = nodes[getNode(existential_variable)];
+  for (auto r: node.rules) {
+    const auto& rule = rules[r];
+    if (model->val(rule.activity_variable) > 0) {
       // Add universal and arbiter variables to support.
-      auto& true_activity_variable_universal_support = activity_variable_to_universal_support[av];
-      universal_support.insert(true_activity_variable_universal_support.begin(), true_activity_variable_universal_support.end());
-      arbiter_support.insert(arbiter_support.end(), activity_variable_to_arbiter_support[av].begin(), activity_variable_to_arbiter_support[av].end());
-      auto& true_activity_variable_existential_support = activity_variable_to_existential_support[av];
-      for (auto e: true_activity_variable_existential_support) {
-        if (existential_variables_seen.find(e) == existential_variables_seen.end() && (solver->val(e) > 0 || getAlias(e) == e)) { // The last condition is an ugly hack to ensure this works both in the validity and consistency checker.
+      for (auto i = rule.begin; i < rule.universals_end; i++) {
+        universal_support.insert(support_entries[i].variable);
+      }
+      for (auto i = rule.universals_end; i < rule.arbiters_end; i++) {
+        arbiter_support.push_back(support_entries[i].variable);
+      }
+      for (auto i = rule.arbiters_end; i < rule.end; i++) {
+        auto [e, e_node] = support_entries[i];
+        if (existential_variables_seen.find(e) == existential_variables_seen.end() && (model->val(e) > 0 || nodes[e_node].is_own_alias)) { // The last condition is an ugly hack to ensure this works both in the validity and consistency checker.
           existential_support.push_back(e);
         }
       }
@@ -11,7 +11,7 @@
 
 #include <assert.h>
 
-#include "satsolver.h"
+#include "modelsnapshot.h"
 #include "solvertypes.h"
 #include "utils.h"
 #include "logging.h"
@@ -26,7 +26,11 @@ namespace pedant {
 class SupportTracker {
  public:
   SupportTracker(const std::vector<int>& universal_variables, const DependencyContainer& dependencies, int& last_used_variable, SolverData& shared_data, const Configuration& config);
-  void setSatSolver(const std::shared_ptr<SatSolver> solver_);
+  /**
+   * The support is computed with respect to model, which is owned by the caller and has to be
+   * updated before getForcedSource, getActiveRuleSupport, getAssertingSupport or computeSupport is called.
+   **/
+  void setModel(const ModelSnapshot& model_);
   void addArbiterVariable(int arbiter_variable);
   void setNoForcedVariable(int variable, int no_forcing_clause_active_variable);
   void addDefiningClause(int variable, const Clause& defining_clause, int activity_variable);
@@ -36,10 +40,11 @@ class SupportTracker {
   /**
    * If replace_initial==true, then literals must have the shape {e,-e}
    * If forced_variable!=0 then the last element of the first component of @return is forced_variable
+   * If log_graph==false, the conflict graph is not logged even if config.log_conflict_graphs is set.
    **/
-  std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> getMinimalSeparator(const std::vector<int>& literals, int forced_variable, bool replace_initial=false);
+  std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> getMinimalSeparator(const std::vector<int>& literals, int forced_variable, bool replace_initial=false, bool log_graph=true);
   void setAlias(int variable, int alias);
-  std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> computeSupport(const std::vector<int>& literals, int forced_variable, bool replace_initial=false);
+  std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> computeSupport(const std::vector<int>& literals, int forced_variable, bool replace_initial=false, bool log_graph=true);
 
   void visualiseGraph(const std::string& fname, const std::vector<int>& literals, const std::vector<int>& mark, int forced_variable, bool replace_initial=false, bool invert_graph=false);
 
@@ -50,6 +55,8 @@ class SupportTracker {
   std::tuple<bool, int> hasForcingClause(std::vector<int>& assigned_existential_variables);
   void insertSupport(int existential_variable, std::vector<int>& existential_support, std::unordered_set<int>& existential_variables_seen, std::set<int>& universal_support, std::vector<int>& arbiter_support);
   bool isForced(int variable);
+  bool isForcedNode(size_t node);
+  size_t getNode(int variable);
   int getConnVar(int variable);
   int getSepVar(int variable);
   int getClVar(int variable);
@@ -63,14 +70,43 @@ class SupportTracker {
 
   void addEdgesToVisualisation(int variable, std::unordered_set<int>& existentials, std::set<int>& existential_terminals, std::set<int>& universals, std::set<int>& arbiters, std::ostream& out, bool invert=false);
 
-  std::shared_ptr<SatSolver> solver;
+  const ModelSnapshot* model = nullptr;
   std::unordered_set<int> universal_variables;
   std::unordered_set<int> arbiter_variables;
-  std::unordered_map<int, int> variable_to_no_forcing_clause_active_variable;
-  std::unordered_map<int, std::vector<int>> variable_to_activity_variables;
-  std::unordered_map<int, std::vector<int>> activity_variable_to_existential_support;
-  std::unordered_map<int, std::vector<int>> activity_variable_to_universal_support;
-  std::unordered_map<int, std::vector<int>> activity_variable_to_arbiter_support;
+
+  /**
+   * Flat index of the implication graph, built incrementally by addDefiningClause.
+   * Each variable with defining clauses (or a no-forcing-clause variable) is a node, each defining clause a rule.
+   * The support of a rule is the span support_entries[begin,end) which holds the universals up to universals_end,
+   * then the arbiters up to arbiters_end and then the existentials. Existential entries refer to their node,
+   * so that walking the graph needs no lookups by variable.
+   **/
+  struct SupportNode {
+    int variable = 0;
+    // 0 if setNoForcedVariable has not been called for the variable.
+    int no_forcing_clause_active_variable = 0;
+    // getAlias(variable) == variable
+    bool is_own_alias = true;
+    std::vector<size_t> rules;
+  };
+  struct SupportRule {
+    int activity_variable;
+    size_t begin;
+    size_t universals_end;
+    size_t arbiters_end;
+    size_t end;
+  };
+  struct SupportEntry {
+    int variable;
+    // Only set for existentials.
+    size_t node;
+  };
+  std::vector<int> supportVariables(size_t begin, size_t end) const;
+
+  std::unordered_map<int, size_t> variable_to_node;
+  std::vector<SupportNode> nodes;
+  std::vector<SupportRule> rules;
+  std::vector<SupportEntry> support_entries;
 
   std::unordered_map<int, int> variable_to_alias;
   std::unordered_map<int, int> alias_to_variable;
@@ -89,8 +125,8 @@ class SupportTracker {
 
 // Definition of inline methods.
 
-inline void SupportTracker::setSatSolver(const std::shared_ptr<SatSolver> solver_) {
-  solver = solver_;
+inline void SupportTracker::setModel(const ModelSnapshot& model_) {
+  model = &model_;
 }
 
 inline void SupportTracker::addArbiterVariable(int arbiter_variable) {
@@ -98,21 +134,29 @@ inline void SupportTracker::addArbiterVariable(int arbiter_variable) {
 }
 
 inline void SupportTracker::setNoForcedVariable(int variable, int no_forcing_clause_active_variable) {
-  variable_to_no_forcing_clause_active_variable[variable] = no_forcing_clause_active_variable;
-}
-
-inline void SupportTracker::addDefiningClause(int variable, const Clause& defining_clause, int activity_variable) {
-  variable_to_activity_variables[variable].push_back(activity_variable);
-  for (int l: defining_clause) {
-    auto v = var(l);
-    if (variable_to_no_forcing_clause_active_variable.find(v) != variable_to_no_forcing_clause_active_variable.end()) {
-      activity_variable_to_existential_support[activity_variable].push_back(v);
-    } else if (universal_variables.find(v) != universal_variables.end()) {
-      activity_variable_to_universal_support[activity_variable].push_back(v);
-    } else if (arbiter_variables.find(v) != arbiter_variables.end()) {
-      activity_variable_to_arbiter_support[activity_variable].push_back(v);
-    }
+  nodes[getNode(variable)].no_forcing_clause_active_variable = no_forcing_clause_active_variable;
+}
+
+/**
+ * Returns the node of variable, a node is created if necessary.
+ **/
+inline size_t SupportTracker::getNode(int variable) {
+  auto [it, inserted] = variable_to_node.emplace(variable, nodes.size());
+  if (inserted) {
+    nodes.emplace_back();
+    nodes.back().variable = variable;
+    nodes.back().is_own_alias = (getAlias(variable) == variable);
   }
+  return it->second;
+}
+
+inline std::vector<int> SupportTracker::supportVariables(size_t begin, size_t end) const {
+  std::vector<int> variables;
+  variables.reserve(end - begin);
+  for (auto i = begin; i < end; i++) {
+    variables.push_back(support_entries[i].variable);
+  }
+  return variables;
 }
 
 inline void SupportTracker::printSupportEdges(int variable, const std::vector<int>& support) {
@@ -124,6 +168,10 @@ inline void SupportTracker::printSupportEdges(int variable, const std::vector<in
 inline void SupportTracker::setAlias(int variable, int alias) {
   variable_to_alias[variable] = alias;
   alias_to_variable[alias] = variable;
+  auto it = variable_to_node.find(variable);
+  if (it != variable_to_node.end()) {
+    nodes[it->second].is_own_alias = (alias == variable);
+  }
 }
 
 inline int SupportTracker::getAlias(int variable) const {
@@ -135,7 +183,11 @@ inline int SupportTracker::fromAlias(int alias) const {
 }
 
 inline bool SupportTracker::isForced(int variable) {
-  return solver->val(variable_to_no_forcing_clause_active_variable[variable]) < 0;
+  return isForcedNode(getNode(variable));
+}
+
+inline bool SupportTracker::isForcedNode(size_t node) {
+  return model->val(nodes[node].no_forcing_clause_active_variable) < 0;
 }
 
 inline int SupportTracker::getConnVar(int variable) {
@@ -159,8 +211,8 @@ inline int SupportTracker::getClVar(int variable) {
   return cl_var[variable];
 }
 
-inline std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::computeSupport(const std::vector<int>& literals, int forced_variable, bool replace_initial) {
-  return getMinimalSeparator(literals, forced_variable, replace_initial);
+inline std::tuple<std::vector<int>, std::vector<int>, std::vector<int>> SupportTracker::computeSupport(const std::vector<int>& literals, int forced_variable, bool replace_initial, bool log_graph) {
+  return getMinimalSeparator(literals, forced_variable, replace_initial, log_graph);
 }
 
 }
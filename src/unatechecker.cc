@@ -6,7 +6,7 @@
 
 namespace pedant {
 
-UnateChecker::UnateChecker(std::vector<Clause>& matrix,
+UnateChecker::UnateChecker(const ClauseDatabase& matrix,
     const std::vector<int>& existentials,
     int& last_used_variable, const Configuration& config) 
     : max_variable(last_used_variable),matrix(matrix),existential_variables(existentials), config(config) {
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "solvertypes.h"
+#include "clausedatabase.h"
 // #include "cadical.h"
 // #include "glucose-ipasir.h"
 #include <memory>
@@ -16,7 +17,7 @@ namespace pedant {
 class UnateChecker {
 
  public:
-  UnateChecker( std::vector<Clause>& matrix,
+  UnateChecker(const ClauseDatabase& matrix,
                 const std::vector<int>& existential_variables,
                 int& last_used_variable, const Configuration& config);
 
@@ -37,7 +38,7 @@ class UnateChecker {
   std::vector<int> renamed_existentials;
   std::vector<int> switches_for_equalities;
 
-  const std::vector<Clause>& matrix;
+  const ClauseDatabase& matrix;
   // std::vector<Clause> negated_matrix;
   std::vector<Clause> equalities_for_renamings;
   // std::vector<Clause> arbiter_clauses;
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "configuration.h"
+#include "dependencycontainer.h"
+#include "dependencyextractor.h"
+#include "dqdimacs.h"
+
+/**
+ * Compares the dependency updates of DependencyContainer_Vector, which selects the variables to update with the
+ * occurrence index of ExtendedDependencies, with the former implementation that tests every undefined variable.
+ *
+ * Usage: dependencybenchmark [--universals <u>] [--existentials <e>] [--dependencies <d>] [--support <s>] [--iterations <i>] [--seed <s>]
+ *
+ * The synthetic DQBF prefix has u universals (default 200) and e existentials (default 10000). Each existential has
+ * explicit dependencies on 1 to d random universals (default 20). The extended dependencies are computed by
+ * DependencyExtractor without dependency schemes.
+ * The updates follow the incremental definability checks of the preprocessing: in each of i iterations (default 2) the
+ * variables in the queue are checked in order, every second one is defined by s random variables of its extended
+ * dependencies (default 3) and the update is scheduled. The updated variables form the queue of the next iteration.
+ * The updated variables and the final extended dependencies are compared, returns 1 if they differ.
+ **/
+
+namespace {
+
+using pedant::Configuration;
+using pedant::DependencyContainer_Vector;
+using pedant::ExtendedDependencies;
+
+struct Parameters {
+  int nof_universals = 200;
+  int nof_existentials = 10000;
+  int nof_dependencies = 20;
+  int support_size = 3;
+  int nof_iterations = 2;
+  unsigned long seed = 1;
+};
+
+/**
+ * DependencyContainer_Vector with the former scheduleUpdate that tests the support set against all undefined variables.
+ **/
+class ScanningDependencyContainer : public DependencyContainer_Vector {
+
+ public:
+  using DependencyContainer_Vector::DependencyContainer_Vector;
+
+  void scheduleUpdate(int variable, const std::set<int>& support_set, std::set<int>& updated_variables) override {
+    extended_dependencies_to_compute.insert(variable);
+    setSupport(variable, support_set);
+    variables_to_update.erase(variable);
+    extended_dependencies_map.erase(variable);
+    for (auto var : undefined_variables) {
+      if (includedInDependencies(var, support_set)) {
+        updated_variables.insert(var);
+        variables_to_update[var].push_back(variable);
+      }
+    }
+  }
+
+};
+
+struct Prefix {
+  std::vector<int> universals;
+  std::unordered_set<int> universal_set;
+  std::vector<int> existentials;
+  std::unordered_map<int, std::vector<int>> dependencies;
+  ExtendedDependencies extended_dependencies;
+};
+
+Prefix randomPrefix(const Parameters& parameters) {
+  std::mt19937 generator(parameters.seed);
+  auto uniform = [&generator](int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+  };
+  Prefix prefix;
+  pedant::DQDIMACS formula(parameters.nof_universals + parameters.nof_existentials);
+  for (int u = 1; u <= parameters.nof_universals; u++) {
+    prefix.universals.push_back(u);
+  }
+  prefix.universal_set.insert(prefix.universals.begin(), prefix.universals.end());
+  formula.addUniversalBlock(prefix.universals);
+  for (int e = parameters.nof_universals + 1; e <= parameters.nof_universals + parameters.nof_existentials; e++) {
+    prefix.existentials.push_back(e);
+    std::vector<int> dependencies;
+    int nof_dependencies = uniform(1, std::min(parameters.nof_dependencies, parameters.nof_universals));
+    for (int i = 0; i < nof_dependencies; i++) {
+      dependencies.push_back(uniform(1, parameters.nof_universals));
+    }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    formula.addExplicitDependencies(e, dependencies);
+  }
+  Configuration config;
+  config.apply_dependency_schemes = false;
+  pedant::DependencyExtractor extractor(formula, config);
+  std::tie(prefix.dependencies, prefix.extended_dependencies) = extractor.getExtendedDependencies();
+  return prefix;
+}
+
+struct Result {
+  double seconds = 0;
+  size_t nof_updates = 0;
+  // The updated variables of each scheduleUpdate call.
+  std::vector<std::set<int>> updated_variables;
+  std::vector<std::vector<int>> final_dependencies;
+};
+
+template<typename C> Result runUpdates(const Parameters& parameters, const Prefix& prefix) {
+  Configuration config;
+  std::set<int> undefined_variables(prefix.existentials.begin(), prefix.existentials.end());
+  auto dependencies = prefix.dependencies;
+  auto extended_dependencies = prefix.extended_dependencies;
+  C container(config, std::move(dependencies), std::move(extended_dependencies), undefined_variables, prefix.universal_set, prefix.universals);
+  std::mt19937 generator(parameters.seed);
+  using clock = std::chrono::steady_clock;
+  clock::duration time{0};
+  Result result;
+  std::set<int> queue(prefix.existentials.begin(), prefix.existentials.end());
+  for (int i = 0; i < parameters.nof_iterations && !queue.empty(); i++) {
+    std::set<int> new_queue;
+    bool define = false;
+    for (auto variable : queue) {
+      define = !define;
+      if (!define || undefined_variables.find(variable) == undefined_variables.end()) {
+        continue;
+      }
+      auto defining_variables = container.getExtendedDependencies(variable);
+      std::shuffle(defining_variables.begin(), defining_variables.end(), generator);
+      defining_variables.resize(std::min<size_t>(defining_variables.size(), parameters.support_size));
+      std::set<int> support_set(defining_variables.begin(), defining_variables.end());
+      undefined_variables.erase(variable);
+      new_queue.erase(variable);
+      std::set<int> updated_variables;
+      auto start = clock::now();
+      container.scheduleUpdate(variable, support_set, updated_variables);
+      time += clock::now() - start;
+      result.nof_updates += updated_variables.size();
+      new_queue.insert(updated_variables.begin(), updated_variables.end());
+      result.updated_variables.push_back(std::move(updated_variables));
+    }
+    auto start = clock::now();
+    container.performUpdate();
+    time += clock::now() - start;
+    queue = std::move(new_queue);
+  }
+  result.seconds = std::chrono::duration<double>(time).count();
+  for (auto e : prefix.existentials) {
+    result.final_dependencies.push_back(container.getExtendedDependencies(e));
+  }
+  return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+  Parameters parameters;
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    if ((argument == "--universals" || argument == "--existentials" || argument == "--dependencies" || argument == "--support"
+         || argument == "--iterations" || argument == "--seed") && i + 1 < argc) {
+      auto value = std::strtol(argv[++i], nullptr, 10);
+      if (argument == "--universals") {
+        parameters.nof_universals = std::max(1L, value);
+      } else if (argument == "--existentials") {
+        parameters.nof_existentials = std::max(1L, value);
+      } else if (argument == "--dependencies") {
+        parameters.nof_dependencies = std::max(1L, value);
+      } else if (argument == "--support") {
+        parameters.support_size = std::max(0L, value);
+      } else if (argument == "--iterations") {
+        parameters.nof_iterations = std::max(1L, value);
+      } else {
+        parameters.seed = value;
+      }
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--universals <u>] [--existentials <e>] [--dependencies <d>] [--support <s>] [--iterations <i>] [--seed <s>]" << std::endl;
+      return 2;
+    }
+  }
+
+  auto prefix = randomPrefix(parameters);
+  std::cout << parameters.nof_universals << " universals, " << parameters.nof_existentials << " existentials, "
+            << prefix.extended_dependencies.totalSize() << " extended dependencies in total" << std::endl;
+  auto indexed = runUpdates<DependencyContainer_Vector>(parameters, prefix);
+  auto scanning = runUpdates<ScanningDependencyContainer>(parameters, prefix);
+  std::cout << indexed.updated_variables.size() << " definitions, " << indexed.nof_updates << " updated variables" << std::endl;
+  std::cout << "DependencyContainer_Vector (occurrence index): " << indexed.seconds << " s" << std::endl;
+  std::cout << "Scan of the undefined variables:               " << scanning.seconds << " s" << std::endl;
+  if (indexed.updated_variables != scanning.updated_variables || indexed.final_dependencies != scanning.final_dependencies) {
+    std::cerr << "The containers computed different extended dependencies." << std::endl;
+    return 1;
+  }
+  return 0;
+}
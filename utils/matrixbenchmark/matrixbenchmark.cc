@@ -0,0 +1,188 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "clausedatabase.h"
+#include "solvertypes.h"
+
+/**
+ * Compares the peak memory of a matrix stored as std::vector<Clause> (the former layout) with a ClauseDatabase.
+ *
+ * Usage: matrixbenchmark [--clauses <c>] [--variables <v>] [--max-length <l>] [--seed <s>]
+ *
+ * The matrix has c random clauses (default 5000000) over v variables (default 100000), with 1 to l literals each (default 8).
+ * Each layout is built in a child process of its own, so that the peak resident set size of the child only reflects
+ * that layout. A child that only generates the clauses without storing them gives the baseline.
+ * The children also measure the time for building the matrix and for one pass over all literals.
+ **/
+
+namespace {
+
+using pedant::Clause;
+using pedant::ClauseDatabase;
+
+enum class Layout { None, Nested, Flat };
+
+struct Parameters {
+  long nof_clauses = 5000000;
+  int nof_variables = 100000;
+  int max_length = 8;
+  unsigned long seed = 1;
+};
+
+/**
+ * Calls add_clause for each random clause. The clause buffer is reused, so generating the clauses does not allocate.
+ **/
+template<typename F> void generateClauses(const Parameters& parameters, F add_clause) {
+  std::mt19937 generator(parameters.seed);
+  std::uniform_int_distribution<int> length_distribution(1, parameters.max_length);
+  std::uniform_int_distribution<int> variable_distribution(1, parameters.nof_variables);
+  Clause clause;
+  clause.reserve(parameters.max_length);
+  for (long i = 0; i < parameters.nof_clauses; i++) {
+    clause.clear();
+    auto length = length_distribution(generator);
+    for (int j = 0; j < length; j++) {
+      auto variable = variable_distribution(generator);
+      clause.push_back((generator() & 1) ? variable : -variable);
+    }
+    add_clause(clause);
+  }
+}
+
+template<typename M> long sumLiterals(const M& matrix) {
+  long sum = 0;
+  for (const auto& clause : matrix) {
+    for (auto l : clause) {
+      sum += l;
+    }
+  }
+  return sum;
+}
+
+/**
+ * Runs in the child process. Writes the build time, the traversal time and the checksum to the pipe.
+ **/
+void buildMatrix(Layout layout, const Parameters& parameters, int pipe_descriptor) {
+  using clock = std::chrono::steady_clock;
+  double times[2] = {0, 0};
+  long sum = 0;
+  if (layout == Layout::None) {
+    generateClauses(parameters, [&sum](const Clause& clause) { sum += clause.size(); });
+  } else if (layout == Layout::Nested) {
+    auto start = clock::now();
+    std::vector<Clause> matrix;
+    generateClauses(parameters, [&matrix](const Clause& clause) { matrix.push_back(clause); });
+    auto middle = clock::now();
+    sum = sumLiterals(matrix);
+    auto end = clock::now();
+    times[0] = std::chrono::duration<double>(middle - start).count();
+    times[1] = std::chrono::duration<double>(end - middle).count();
+  } else {
+    auto start = clock::now();
+    ClauseDatabase matrix;
+    generateClauses(parameters, [&matrix](const Clause& clause) { matrix.addClause(clause); });
+    auto middle = clock::now();
+    sum = sumLiterals(matrix);
+    auto end = clock::now();
+    times[0] = std::chrono::duration<double>(middle - start).count();
+    times[1] = std::chrono::duration<double>(end - middle).count();
+  }
+  if (write(pipe_descriptor, times, sizeof(times)) != sizeof(times) || write(pipe_descriptor, &sum, sizeof(sum)) != sizeof(sum)) {
+    _exit(1);
+  }
+}
+
+struct Result {
+  bool valid = false;
+  long peak_kilobytes = 0;
+  double build_seconds = 0;
+  double traversal_seconds = 0;
+  long sum = 0;
+};
+
+Result measure(Layout layout, const Parameters& parameters) {
+  Result result;
+  int pipe_descriptors[2];
+  if (pipe(pipe_descriptors) != 0) {
+    return result;
+  }
+  auto pid = fork();
+  if (pid < 0) {
+    close(pipe_descriptors[0]);
+    close(pipe_descriptors[1]);
+    return result;
+  } else if (pid == 0) {
+    close(pipe_descriptors[0]);
+    buildMatrix(layout, parameters, pipe_descriptors[1]);
+    _exit(0);
+  }
+  close(pipe_descriptors[1]);
+  double times[2];
+  bool read_ok = read(pipe_descriptors[0], times, sizeof(times)) == sizeof(times)
+                 && read(pipe_descriptors[0], &result.sum, sizeof(result.sum)) == sizeof(result.sum);
+  close(pipe_descriptors[0]);
+  int status;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !read_ok) {
+    return result;
+  }
+  result.valid = true;
+  result.peak_kilobytes = usage.ru_maxrss;
+  result.build_seconds = times[0];
+  result.traversal_seconds = times[1];
+  return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+  Parameters parameters;
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    if ((argument == "--clauses" || argument == "--variables" || argument == "--max-length" || argument == "--seed") && i + 1 < argc) {
+      auto value = std::strtol(argv[++i], nullptr, 10);
+      if (argument == "--clauses") {
+        parameters.nof_clauses = std::max(0L, value);
+      } else if (argument == "--variables") {
+        parameters.nof_variables = std::max(1L, value);
+      } else if (argument == "--max-length") {
+        parameters.max_length = std::max(1L, value);
+      } else {
+        parameters.seed = value;
+      }
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--clauses <c>] [--variables <v>] [--max-length <l>] [--seed <s>]" << std::endl;
+      return 2;
+    }
+  }
+
+  auto baseline = measure(Layout::None, parameters);
+  auto nested = measure(Layout::Nested, parameters);
+  auto flat = measure(Layout::Flat, parameters);
+  if (!baseline.valid || !nested.valid || !flat.valid) {
+    std::cerr << "A measurement failed." << std::endl;
+    return 2;
+  }
+  if (nested.sum != flat.sum) {
+    std::cerr << "The layouts contain different literals." << std::endl;
+    return 1;
+  }
+  auto report = [&baseline](const std::string& name, const Result& result) {
+    std::cout << name << (result.peak_kilobytes - baseline.peak_kilobytes) / 1024.0 << " MB above baseline, build "
+              << result.build_seconds << " s, traversal " << result.traversal_seconds << " s" << std::endl;
+  };
+  std::cout << parameters.nof_clauses << " clauses, baseline peak RSS " << baseline.peak_kilobytes / 1024.0 << " MB" << std::endl;
+  report("std::vector<Clause>: ", nested);
+  report("ClauseDatabase:      ", flat);
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dqdimacsparser.h"
+#include "streamparser.h"
+
+/**
+ * Compares the throughput of DQDIMACSParser with the getline/stringstream reference implementation.
+ *
+ * Usage: parserbenchmark [--universals <u>] [--existentials <e>] [--clauses <c>] [--seed <s>] [--repetitions <r>] [<file>...]
+ *
+ * Without files, a random DQDIMACS instance with u universals (default 1000), e existentials (default 20000) and
+ * c clauses (default 1000000) is written to a temporary file. Half of the existentials get explicit dependencies.
+ * Each file is parsed r times (default 3) by each parser, the resulting formulas are compared.
+ * Returns 1 if the formulas differ.
+ **/
+
+namespace {
+
+using pedant::DQDIMACS;
+using pedant::DQDIMACSParser;
+using pedant::StreamDQDIMACSParser;
+
+void writeInstance(std::ostream& out, int nof_universals, int nof_existentials, long nof_clauses, std::mt19937& generator) {
+  auto uniform = [&generator](int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+  };
+  int max_var = nof_universals + nof_existentials;
+  out << "c random instance generated by parserbenchmark\n";
+  out << "p cnf " << max_var << " " << nof_clauses << "\n";
+  out << "a";
+  for (int u = 1; u <= nof_universals; u++) {
+    out << " " << u;
+  }
+  out << " 0\n";
+  int nof_implicit = nof_existentials / 2;
+  out << "e";
+  for (int e = nof_universals + 1; e <= nof_universals + nof_implicit; e++) {
+    out << " " << e;
+  }
+  out << " 0\n";
+  for (int e = nof_universals + nof_implicit + 1; e <= max_var; e++) {
+    out << "d " << e;
+    int nof_dependencies = uniform(0, std::min(nof_universals, 20));
+    for (int i = 0; i < nof_dependencies; i++) {
+      out << " " << uniform(1, nof_universals);
+    }
+    out << " 0\n";
+  }
+  for (long i = 0; i < nof_clauses; i++) {
+    int length = uniform(1, 6);
+    for (int j = 0; j < length; j++) {
+      int variable = uniform(1, max_var);
+      out << (uniform(0, 1) ? variable : -variable) << (uniform(0, 15) == 0 ? "  " : " ");
+    }
+    out << "0\n";
+    if (uniform(0, 999) == 0) {
+      out << "c comment\n";
+    }
+  }
+}
+
+bool sameFormula(DQDIMACS& formula, DQDIMACS& reference) {
+  return formula.getMaxVar() == reference.getMaxVar()
+      && formula.getUniversals() == reference.getUniversals()
+      && formula.getExistentials() == reference.getExistentials()
+      && formula.getUniversalBlocks() == reference.getUniversalBlocks()
+      && formula.getExistentialBlocks() == reference.getExistentialBlocks()
+      && formula.getExplicitDependencies() == reference.getExplicitDependencies()
+      && formula.getMatrix().getLiterals() == reference.getMatrix().getLiterals()
+      && formula.getMatrix().getOffsets() == reference.getMatrix().getOffsets();
+}
+
+long fileSize(const std::string& fname) {
+  std::ifstream file(fname, std::ios::binary | std::ios::ate);
+  return file ? static_cast<long>(file.tellg()) : 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+  long nof_universals = 1000;
+  long nof_existentials = 20000;
+  long nof_clauses = 1000000;
+  unsigned long seed = 1;
+  int repetitions = 3;
+  std::vector<std::string> filenames;
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    if ((argument == "--universals" || argument == "--existentials" || argument == "--clauses" || argument == "--seed" || argument == "--repetitions") && i + 1 < argc) {
+      auto value = std::strtol(argv[++i], nullptr, 10);
+      if (argument == "--universals") {
+        nof_universals = std::max(1L, value);
+      } else if (argument == "--existentials") {
+        nof_existentials = std::max(2L, value);
+      } else if (argument == "--clauses") {
+        nof_clauses = std::max(0L, value);
+      } else if (argument == "--seed") {
+        seed = value;
+      } else {
+        repetitions = std::max(1L, value);
+      }
+    } else if (argument.rfind("--", 0) == 0) {
+      std::cerr << "Usage: " << argv[0] << " [--universals <u>] [--existentials <e>] [--clauses <c>] [--seed <s>] [--repetitions <r>] [<file>...]" << std::endl;
+      return 2;
+    } else {
+      filenames.push_back(argument);
+    }
+  }
+
+  std::string generated_file;
+  if (filenames.empty()) {
+    const char* directory = std::getenv("TMPDIR");
+    std::string name_template = std::string(directory != nullptr ? directory : "/tmp") + "/parserbenchmark.XXXXXX";
+    std::vector<char> name(name_template.begin(), name_template.end());
+    name.push_back('\0');
+    int file_descriptor = mkstemp(name.data());
+    if (file_descriptor < 0) {
+      std::cerr << "Could not create a temporary file." << std::endl;
+      return 2;
+    }
+    close(file_descriptor);
+    generated_file = name.data();
+    std::ofstream out(generated_file);
+    std::mt19937 generator(seed);
+    writeInstance(out, nof_universals, nof_existentials, nof_clauses, generator);
+    if (!out) {
+      std::cerr << "Could not write " << generated_file << "." << std::endl;
+      std::remove(generated_file.c_str());
+      return 2;
+    }
+    filenames.push_back(generated_file);
+  }
+
+  using clock = std::chrono::steady_clock;
+  size_t mismatches = 0;
+  for (const auto& fname : filenames) {
+    try {
+      clock::duration time_mapped{0}, time_stream{0};
+      DQDIMACS formula, reference;
+      for (int r = 0; r < repetitions; r++) {
+        auto start = clock::now();
+        formula = DQDIMACSParser().parseFormula(fname);
+        auto middle = clock::now();
+        reference = StreamDQDIMACSParser().parseFormula(fname);
+        auto end = clock::now();
+        time_mapped += middle - start;
+        time_stream += end - middle;
+      }
+      bool same = sameFormula(formula, reference);
+      if (!same) {
+        mismatches++;
+      }
+      auto megabytes = fileSize(fname) / 1e6;
+      auto throughput = [megabytes, repetitions](clock::duration time) {
+        return megabytes * repetitions / std::max(std::chrono::duration<double>(time).count(), 1e-9);
+      };
+      std::cout << fname << ": " << megabytes << " MB, " << formula.getMatrix().size() << " clauses, "
+                << (same ? "same formula" : "FORMULAS DIFFER") << std::endl;
+      std::cout << "  DQDIMACSParser:       " << throughput(time_mapped) << " MB/s" << std::endl;
+      std::cout << "  StreamDQDIMACSParser: " << throughput(time_stream) << " MB/s" << std::endl;
+    } catch (pedant::InvalidFileException& e) {
+      std::cerr << fname << ": " << e.what() << std::endl;
+      mismatches++;
+    }
+  }
+  if (!generated_file.empty()) {
+    std::remove(generated_file.c_str());
+  }
+  return mismatches == 0 ? 0 : 1;
+}
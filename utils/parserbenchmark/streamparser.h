@@ -0,0 +1,37 @@
+#ifndef PEDANT_STREAMPARSER_H_
+#define PEDANT_STREAMPARSER_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "dqdimacs.h"
+
+namespace pedant {
+
+
+/**
+ * The getline/stringstream implementation that DQDIMACSParser used before the memory-mapped scanner,
+ * kept as a reference for parserbenchmark. Only reads plain files.
+ **/
+class StreamDQDIMACSParser {
+
+ public:
+  DQDIMACS parseFormula(const std::string& fname);
+
+ private:
+
+  int processPrefix(std::istream& in);
+  int parsePrefix(const std::string& line);
+  void parseUniversalBlock(const std::string& line, DQDIMACS& formula);
+  void parseExistentialBlock(const std::string& line, DQDIMACS& formula);
+  void parseDependencyBlock(const std::string& line, DQDIMACS& formula);
+  void parseClause(const std::string& line, DQDIMACS& formula);
+
+  std::vector<int> parseLine(const std::string& line, bool check_is_positive) const;
+
+};
+
+}
+
+#endif // PEDANT_STREAMPARSER_H_
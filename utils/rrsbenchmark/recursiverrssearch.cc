@@ -0,0 +1,71 @@
+#include <cstdlib>
+
+#include "recursiverrssearch.h"
+
+namespace pedant {
+
+RecursiveRRSSearch::RecursiveRRSSearch(const ClauseDatabase& matrix, int max_variable) : matrix(matrix), max_variable_in_matrix(max_variable),
+    marked_positive(2*max_variable, false), marked_negative(2*max_variable, false), to_consider(max_variable, false) {
+  for (size_t i = 0; i < matrix.size(); i++) {
+    for (int l:matrix[i]) {
+      containing_clauses[l].push_back(i);
+    }
+  }
+}
+
+void RecursiveRRSSearch::searchPaths(int literal_to_start, std::vector<bool>& marked) {
+  int to_consider_index=abs(literal_to_start)-1;
+  int marked_index=(literal_to_start<0 ? -literal_to_start+max_variable_in_matrix : literal_to_start)-1;
+  //We only have to consider the literal if the associated variable shall be considered and the literal was not already visited
+  if (to_consider[to_consider_index]&&!marked[marked_index]) {
+    marked[marked_index]=true;
+    for (int clause_index : containing_clauses[-literal_to_start]) {
+      for (int l:matrix[clause_index]) {
+        //the next literal has to be associated to a different variable. As literal_to_start is already marked it suffices to exclude -literal_to_start.
+        if (l!=-literal_to_start) {
+          searchPaths(l,marked);
+        }
+      }
+    }
+  }
+}
+
+void RecursiveRRSSearch::setUpSearchVectors(int universal, const std::vector<int>& candidates, const std::vector<int>& passable) {
+  for (const auto* variables : {&candidates, &passable}) {
+    for (int e:*variables) {
+      marked_positive[e-1]=false;
+      marked_positive[e+max_variable_in_matrix-1]=false;
+      marked_negative[e-1]=false;
+      marked_negative[e+max_variable_in_matrix-1]=false;
+      to_consider[e-1]=true;
+    }
+  }
+  marked_negative[universal-1]=true;
+  marked_positive[universal+max_variable_in_matrix-1]=true;
+  to_consider[universal-1]=true;
+}
+
+void RecursiveRRSSearch::revertSearchVectors(int universal, const std::vector<int>& candidates, const std::vector<int>& passable) {
+  for (const auto* variables : {&candidates, &passable}) {
+    for (int e:*variables) {
+      to_consider[e-1] = false;
+    }
+  }
+  to_consider[universal-1] = false;
+}
+
+void RecursiveRRSSearch::findDependentVariables(int universal, const std::vector<int>& candidates, const std::vector<int>& passable, std::vector<int>& result) {
+  setUpSearchVectors(universal, candidates, passable);
+  searchPaths(universal, marked_positive);
+  searchPaths(-universal, marked_negative);
+  revertSearchVectors(universal, candidates, passable);
+  for (int e:candidates) {
+    //There is a RRS path
+    if (  (marked_positive[e-1] && marked_negative[e+max_variable_in_matrix-1]) ||
+          (marked_positive[e+max_variable_in_matrix-1] && marked_negative[e-1]) ) {
+      result.push_back(e);
+    }
+  }
+}
+
+}
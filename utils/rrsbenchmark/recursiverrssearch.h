@@ -0,0 +1,43 @@
+#ifndef PEDANT_RECURSIVERRSSEARCH_H_
+#define PEDANT_RECURSIVERRSSEARCH_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "clausedatabase.h"
+
+namespace pedant {
+
+
+/**
+ * The recursive resolution path search that DependencyExtractor used before RRSEngine, kept as a reference for rrsbenchmark.
+ * The occurrence lists are kept in a hash map and the marks in bit vectors indexed by the variable names.
+ * The recursion depth grows with the length of the resolution paths, so the caller has to provide a large stack.
+ **/
+class RecursiveRRSSearch {
+
+ public:
+  RecursiveRRSSearch(const ClauseDatabase& matrix, int max_variable);
+
+  /**
+   * Same interface and result as RRSEngine::findDependentVariables.
+   **/
+  void findDependentVariables(int universal, const std::vector<int>& candidates, const std::vector<int>& passable, std::vector<int>& result);
+
+ private:
+  void searchPaths(int literal_to_start, std::vector<bool>& marked);
+  void setUpSearchVectors(int universal, const std::vector<int>& candidates, const std::vector<int>& passable);
+  void revertSearchVectors(int universal, const std::vector<int>& candidates, const std::vector<int>& passable);
+
+  const ClauseDatabase& matrix;
+  const int max_variable_in_matrix;
+  std::unordered_map<int,std::vector<int>> containing_clauses;
+  std::vector<bool> marked_positive;
+  std::vector<bool> marked_negative;
+  std::vector<bool> to_consider;
+
+};
+
+}
+
+#endif // PEDANT_RECURSIVERRSSEARCH_H_
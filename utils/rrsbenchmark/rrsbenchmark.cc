@@ -0,0 +1,212 @@
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "clausedatabase.h"
+#include "parallel.h"
+#include "rrsengine.h"
+#include "recursiverrssearch.h"
+
+/**
+ * Measures the cost per universal of the RRS dependency scheme for RRSEngine and the recursive reference implementation.
+ *
+ * Usage: rrsbenchmark [--universals <u>] [--existentials <e>] [--dependencies <d>] [--passable <p>] [--clauses <c>] [--seed <s>] [--threads <t>] [--no-reference]
+ *
+ * The random formula has u universals (default 100000) and e existentials (default 50000), each existential depends
+ * on d random universals (default 20). The last p existentials (default 1000) form the innermost block, which is ignored
+ * by the dependency scheme, so the resolution paths may pass through them. The matrix has c clauses (default 200000)
+ * with 2 to 4 literals.
+ * RRSEngine uses t threads (default 1, 0 means one per hardware thread), as with --rrs-threads.
+ * The dependent existentials of each universal are compared, returns 1 if they differ.
+ **/
+
+namespace {
+
+using pedant::ClauseDatabase;
+using pedant::RecursiveRRSSearch;
+using pedant::RRSEngine;
+
+struct Parameters {
+  int nof_universals = 100000;
+  int nof_existentials = 50000;
+  int nof_dependencies = 20;
+  int nof_passable = 1000;
+  long nof_clauses = 200000;
+  unsigned long seed = 1;
+  unsigned threads = 1;
+  bool run_reference = true;
+};
+
+struct Instance {
+  ClauseDatabase matrix;
+  int max_variable;
+  // The candidates of universal u are the existentials that depend on u.
+  std::vector<int> universals;
+  std::vector<std::vector<int>> candidates;
+  std::vector<int> passable;
+};
+
+Instance randomInstance(const Parameters& parameters) {
+  std::mt19937 generator(parameters.seed);
+  auto uniform = [&generator](int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+  };
+  Instance instance;
+  instance.max_variable = parameters.nof_universals + parameters.nof_existentials;
+  instance.candidates.resize(parameters.nof_universals);
+  for (int u = 1; u <= parameters.nof_universals; u++) {
+    instance.universals.push_back(u);
+  }
+  int first_passable = instance.max_variable - std::min(parameters.nof_passable, parameters.nof_existentials) + 1;
+  for (int e = first_passable; e <= instance.max_variable; e++) {
+    instance.passable.push_back(e);
+  }
+  std::vector<std::vector<int>> dependencies(instance.max_variable + 1);
+  for (int e = parameters.nof_universals + 1; e < first_passable; e++) {
+    for (int i = 0; i < parameters.nof_dependencies; i++) {
+      auto u = uniform(1, parameters.nof_universals);
+      auto& candidates = instance.candidates[u - 1];
+      if (candidates.empty() || candidates.back() != e) {
+        candidates.push_back(e);
+        dependencies[e].push_back(u);
+      }
+    }
+  }
+  // Each clause contains an existential, a universal it depends on (if any) and further existentials.
+  std::vector<int> clause;
+  for (long i = 0; i < parameters.nof_clauses; i++) {
+    clause.clear();
+    int e = uniform(parameters.nof_universals + 1, instance.max_variable);
+    clause.push_back(uniform(0, 1) ? e : -e);
+    if (!dependencies[e].empty()) {
+      int u = dependencies[e][uniform(0, dependencies[e].size() - 1)];
+      clause.push_back(uniform(0, 1) ? u : -u);
+    }
+    int length = uniform(2, 4);
+    while (static_cast<int>(clause.size()) < length) {
+      int e = uniform(parameters.nof_universals + 1, instance.max_variable);
+      if (std::find(clause.begin(), clause.end(), e) == clause.end() && std::find(clause.begin(), clause.end(), -e) == clause.end()) {
+        clause.push_back(uniform(0, 1) ? e : -e);
+      }
+    }
+    instance.matrix.addClause(clause);
+  }
+  return instance;
+}
+
+int run(const Parameters& parameters) {
+  using clock = std::chrono::steady_clock;
+  auto seconds = [](clock::duration time) {
+    return std::chrono::duration<double>(time).count();
+  };
+  auto instance = randomInstance(parameters);
+  auto nof_universals = instance.universals.size();
+  std::cout << nof_universals << " universals, " << parameters.nof_existentials << " existentials, "
+            << instance.matrix.size() << " clauses" << std::endl;
+
+  auto start = clock::now();
+  RRSEngine engine(instance.matrix, instance.max_variable);
+  auto number_of_workers = std::min<size_t>(pedant::numberOfWorkers(parameters.threads), nof_universals);
+  std::vector<RRSEngine::SearchState> search_states;
+  for (size_t i = 0; i < number_of_workers; i++) {
+    search_states.push_back(engine.createSearchState());
+  }
+  auto setup_end = clock::now();
+  std::vector<std::vector<int>> dependent(nof_universals);
+  pedant::parallelFor(nof_universals, number_of_workers, [&](size_t i, unsigned worker) {
+    engine.findDependentVariables(instance.universals[i], instance.candidates[i], instance.passable, search_states[worker], dependent[i]);
+  });
+  auto end = clock::now();
+  std::cout << "RRSEngine (" << number_of_workers << " threads): setup " << seconds(setup_end - start) << " s, "
+            << 1e6 * seconds(end - setup_end) / nof_universals << " us per universal" << std::endl;
+
+  if (!parameters.run_reference) {
+    return 0;
+  }
+  start = clock::now();
+  RecursiveRRSSearch reference(instance.matrix, instance.max_variable);
+  setup_end = clock::now();
+  std::vector<std::vector<int>> reference_dependent(nof_universals);
+  for (size_t i = 0; i < nof_universals; i++) {
+    reference.findDependentVariables(instance.universals[i], instance.candidates[i], instance.passable, reference_dependent[i]);
+  }
+  end = clock::now();
+  std::cout << "RecursiveRRSSearch: setup " << seconds(setup_end - start) << " s, "
+            << 1e6 * seconds(end - setup_end) / nof_universals << " us per universal" << std::endl;
+
+  size_t mismatches = 0;
+  size_t nof_dependencies = 0;
+  for (size_t i = 0; i < nof_universals; i++) {
+    std::sort(dependent[i].begin(), dependent[i].end());
+    std::sort(reference_dependent[i].begin(), reference_dependent[i].end());
+    nof_dependencies += dependent[i].size();
+    if (dependent[i] != reference_dependent[i]) {
+      mismatches++;
+    }
+  }
+  std::cout << nof_dependencies << " dependencies kept, " << mismatches << " universals with different results." << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
+
+struct Task {
+  Parameters parameters;
+  int result = 2;
+};
+
+void* runTask(void* argument) {
+  auto task = static_cast<Task*>(argument);
+  task->result = run(task->parameters);
+  return nullptr;
+}
+
+}
+
+int main(int argc, char** argv) {
+  Task task;
+  auto& parameters = task.parameters;
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    if (argument == "--no-reference") {
+      parameters.run_reference = false;
+    } else if ((argument == "--universals" || argument == "--existentials" || argument == "--dependencies" || argument == "--passable" || argument == "--clauses"
+                || argument == "--seed" || argument == "--threads") && i + 1 < argc) {
+      auto value = std::strtol(argv[++i], nullptr, 10);
+      if (argument == "--universals") {
+        parameters.nof_universals = std::max(1L, value);
+      } else if (argument == "--existentials") {
+        parameters.nof_existentials = std::max(3L, value);
+      } else if (argument == "--dependencies") {
+        parameters.nof_dependencies = std::max(0L, value);
+      } else if (argument == "--passable") {
+        parameters.nof_passable = std::max(0L, value);
+      } else if (argument == "--clauses") {
+        parameters.nof_clauses = std::max(0L, value);
+      } else if (argument == "--seed") {
+        parameters.seed = value;
+      } else {
+        parameters.threads = std::max(0L, value);
+      }
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--universals <u>] [--existentials <e>] [--dependencies <d>] [--passable <p>] [--clauses <c>] [--seed <s>] [--threads <t>] [--no-reference]" << std::endl;
+      return 2;
+    }
+  }
+  // The reference implementation recurses along the resolution paths, thus it needs a large stack.
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstacksize(&attributes, static_cast<size_t>(1) << 30);
+  pthread_t thread;
+  if (pthread_create(&thread, &attributes, runTask, &task) != 0) {
+    std::cerr << "Could not start the benchmark thread." << std::endl;
+    return 2;
+  }
+  pthread_join(thread, nullptr);
+  pthread_attr_destroy(&attributes);
+  return task.result;
+}
@@ -0,0 +1,161 @@
+#include <cassert>
+#include <queue>
+
+#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+
+#include "boostseparator.h"
+
+
+namespace pedant {
+
+std::vector<int> BoostGraphSeparator::getVertexSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
+                                                         const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
+                                                         const std::vector<int>& to_avoid) {
+  BoostGraphSeparator gP(vertices, edges);
+  return gP.getVertexSeparator(vertA, vertB, forbidden, to_avoid);
+}
+
+BoostGraphSeparator::BoostGraphSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges) : vertex_names(vertices) {
+  auto capacity = get(boost::edge_capacity, g);
+  auto rev = get(boost::edge_reverse, g);
+  std::vector<Traits::vertex_descriptor> verts;
+  verts.reserve(2*vertices.size()+2);
+  //we add a source and a sink vertex and each original vertex is represented by an in and an out vertex
+  for (size_t vi = 0; vi < 2*vertices.size()+2; ++vi) {
+    verts.push_back(add_vertex(g));
+  }
+  for (size_t i = 0; i < vertices.size(); i++) {
+    vertex_indices[vertices[i]] = 2*i+1;
+    //setup "internal" edges
+    addEdge(verts[2*i+1], verts[2*i+2], capacity, rev);
+  }
+  for (auto [source, target] : edges) {
+    int idx1 = vertex_indices[source] + 1; //we have to use the out node from the internal edge representation
+    int idx2 = vertex_indices[target];
+    addEdge(verts[idx1], verts[idx2], capacity, rev);
+  }
+}
+
+void BoostGraphSeparator::addEdge(Traits::vertex_descriptor source, Traits::vertex_descriptor target,
+    boost::property_map<Graph,boost::edge_capacity_t>::type& capacity,
+    boost::property_map<Graph,boost::edge_reverse_t>::type& reverse, int weight) {
+  auto e1 = add_edge(source, target, g).first;
+  auto e2 = add_edge(target, source, g).first;
+  capacity[e1] = weight;
+  capacity[e2] = 0;
+  reverse[e1] = e2;
+  reverse[e2] = e1;
+}
+
+void BoostGraphSeparator::connectToSource(const std::vector<int>& to_connect, std::vector<Traits::vertex_descriptor>& verts,
+    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
+    boost::property_map < Graph, boost::edge_reverse_t >::type& rev, unsigned int penalty) {
+  for (int v : to_connect) {
+    addEdge(verts.front(), verts[vertex_indices[v]], capacity, rev, penalty);
+  }
+}
+
+void BoostGraphSeparator::connectToSink(const std::vector<int>& to_connect, std::vector<Traits::vertex_descriptor>& verts,
+    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
+    boost::property_map < Graph, boost::edge_reverse_t >::type& rev) {
+  for (int v : to_connect) {
+    addEdge(verts[vertex_indices[v]+1], verts.back(), capacity, rev, external_capacity);
+  }
+}
+
+std::vector<int> BoostGraphSeparator::getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& unpreferred) {
+  auto [vert_beg, vert_end] = vertices(g);
+  std::vector<Traits::vertex_descriptor> verts(vert_beg,vert_end);
+  auto capacity = get(boost::edge_capacity, g);
+  auto rev = get(boost::edge_reverse, g);
+  // See GraphSeparator::build for the choice of the capacities.
+  int penalty = internal_capacity * vertA.size() + 1;
+  penalty += unpreferred.size();
+  connectToSource(vertA, verts, capacity, rev, penalty);
+  connectToSink(vertB, verts, capacity, rev);
+  applyPenalties(forbidden, verts, capacity, penalty);
+  applyPenalties(unpreferred, verts, capacity, unpreferred_capacity);
+  boykov_kolmogorov_max_flow(g, verts.front(), verts.back());
+  auto sep_edges = getSeparatingEdges(verts.front());
+  return vertexSeparatorFromEdgeSeparator(sep_edges);
+}
+
+void BoostGraphSeparator::applyPenalties(const std::vector<int>& to_apply, std::vector<Traits::vertex_descriptor>& verts,
+    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty) {
+  for (int f : to_apply) {
+    applyPenalty(f, verts, capacity, penalty);
+  }
+}
+
+void BoostGraphSeparator::applyPenalty(int to_apply, std::vector<Traits::vertex_descriptor>& verts,
+    boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty) {
+  int idx = vertex_indices[to_apply];
+  auto internal_edge = boost::edge(verts[idx],verts[idx+1],g).first;
+  capacity[internal_edge] = penalty;
+  boost::graph_traits < Graph >::out_edge_iterator ei, e_end;
+  for (boost::tie(ei, e_end) = boost::out_edges(verts[idx+1], g); ei != e_end; ++ei) {
+    if (capacity[*ei] > 0) { //it is an outgoing edge
+      capacity[*ei] = penalty;
+    }
+  }
+}
+
+std::vector<int> BoostGraphSeparator::vertexSeparatorFromEdgeSeparator(const std::vector<Traits::edge_descriptor>& edge_separator) {
+  auto index_map = get(boost::vertex_index, g);
+  std::vector<int> vertex_separator;
+  vertex_separator.reserve(edge_separator.size());
+  for (auto edge : edge_separator) {
+    auto t_idx = index_map[boost::target(edge,g)];
+    assert (t_idx == index_map[boost::source(edge,g)]+1);
+    int vertex_index = t_idx/2;
+    //in the internal representation the source has index 0, thus we have to subtract 1
+    vertex_separator.push_back(vertex_names[vertex_index-1]);
+  }
+  return vertex_separator;
+}
+
+std::vector<bool> BoostGraphSeparator::reachableInResidualGraph(Traits::vertex_descriptor& source) {
+  auto residual_capacity = get(boost::edge_residual_capacity, g);
+  auto index_map = get(boost::vertex_index, g);
+  std::vector<bool> vertex_reachable(num_vertices(g), false);
+  std::queue<Traits::vertex_descriptor> queued_vertices;
+  queued_vertices.push(source);
+  vertex_reachable[index_map[source]] = true;
+  while (!queued_vertices.empty()) {
+    auto vert = queued_vertices.front();
+    queued_vertices.pop();
+    boost::graph_traits < Graph >::out_edge_iterator ei, e_end;
+    for (boost::tie(ei, e_end) = out_edges(vert, g); ei != e_end; ++ei) {
+      if (residual_capacity[*ei] > 0) {
+        auto v = boost::target(*ei,g);
+        if (!vertex_reachable[index_map[v]]) {
+          vertex_reachable[index_map[v]] = true;
+          queued_vertices.push(v);
+        }
+      }
+    }
+  }
+  return vertex_reachable;
+}
+
+std::vector<BoostGraphSeparator::Traits::edge_descriptor> BoostGraphSeparator::getSeparatingEdges(Traits::vertex_descriptor& source) {
+  std::vector<bool> vertex_reachable = reachableInResidualGraph(source);
+  auto [vert_beg, vert_end] = vertices(g);
+  std::vector<Traits::vertex_descriptor> verts(vert_beg,vert_end);
+  auto capacity = get(boost::edge_capacity, g);
+  auto rev = get(boost::edge_reverse, g);
+  auto index_map = get(boost::vertex_index, g);
+  std::vector<Traits::edge_descriptor> result;
+  for (size_t idx = 0; idx < vertex_reachable.size(); idx++) {
+    if (!vertex_reachable[idx]) {
+      for (auto [ei,e_end] = out_edges(verts[idx], g); ei != e_end; ++ei) {
+        if (capacity[*ei] == 0 && vertex_reachable[index_map[boost::target(*ei,g)]]) { //a capacity of 0 effectively means that this edge is an input edge
+          result.push_back(rev[*ei]);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+}
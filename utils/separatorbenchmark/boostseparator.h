@@ -0,0 +1,80 @@
+#ifndef PEDANT_BOOSTSEPARATOR_H_
+#define PEDANT_BOOSTSEPARATOR_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <boost/config.hpp>
+#include <boost/graph/adjacency_list.hpp>
+
+namespace pedant {
+
+
+/**
+ * The Boost based implementation that GraphSeparator used before the CSR engine, kept as a reference for separatorbenchmark.
+ * It builds a boost::adjacency_list on the same split graph with the same capacities and runs the Boykov-Kolmogorov max-flow.
+ **/
+class BoostGraphSeparator {
+
+  typedef boost::adjacency_list_traits < boost::vecS, boost::vecS, boost::directedS > Traits;
+  typedef boost::adjacency_list < boost::vecS, boost::vecS, boost::directedS,
+    boost::property < boost::vertex_name_t, std::string,
+    boost::property < boost::vertex_index_t, long,
+    boost::property < boost::vertex_color_t, boost::default_color_type,
+    boost::property < boost::vertex_distance_t, long,
+    boost::property < boost::vertex_predecessor_t, Traits::edge_descriptor > > > > >,
+    boost::property < boost::edge_capacity_t, long,
+    boost::property < boost::edge_residual_capacity_t, long,
+    boost::property < boost::edge_reverse_t, Traits::edge_descriptor > > > > Graph;
+
+ public:
+
+  /**
+   * Same interface and result as GraphSeparator::getVertexSeparator, except that the separator is not sorted.
+   **/
+  static std::vector<int> getVertexSeparator( const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges,
+                                              const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden,
+                                              const std::vector<int>& to_avoid);
+
+  BoostGraphSeparator() = delete;
+
+ private:
+
+  BoostGraphSeparator(const std::vector<int>& vertices, const std::vector<std::pair<int,int>>& edges);
+
+  std::vector<int> getVertexSeparator(const std::vector<int>& vertA, const std::vector<int>& vertB, const std::vector<int>& forbidden, const std::vector<int>& to_avoid);
+
+  // Nodes reachable from source in the residual graph.
+  std::vector<bool> reachableInResidualGraph(Traits::vertex_descriptor& source);
+  // Edges from reachable to unreachable nodes.
+  std::vector<Traits::edge_descriptor> getSeparatingEdges(Traits::vertex_descriptor& source);
+  std::vector<int> vertexSeparatorFromEdgeSeparator(const std::vector<Traits::edge_descriptor>& edge_separator);
+
+  void applyPenalties(const std::vector<int>& to_apply, std::vector<Traits::vertex_descriptor>& verts,
+      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty);
+  void applyPenalty(int to_apply, std::vector<Traits::vertex_descriptor>& verts,
+      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity, int penalty);
+  void addEdge(Traits::vertex_descriptor source, Traits::vertex_descriptor target,
+      boost::property_map<Graph,boost::edge_capacity_t>::type& capacity,
+      boost::property_map<Graph,boost::edge_reverse_t>::type& reverse, int weight = internal_capacity);
+  void connectToSource(const std::vector<int>& to_connect, std::vector<Traits::vertex_descriptor>& verts,
+      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
+      boost::property_map < Graph, boost::edge_reverse_t >::type& rev, unsigned int penalty);
+  void connectToSink(const std::vector<int>& to_connect, std::vector<Traits::vertex_descriptor>& verts,
+      boost::property_map < Graph, boost::edge_capacity_t >::type& capacity,
+      boost::property_map < Graph, boost::edge_reverse_t >::type& rev);
+
+  Graph g;
+  std::unordered_map<int,int> vertex_indices;
+  const std::vector<int> vertex_names;
+
+  static constexpr int internal_capacity = 2;
+  static constexpr int unpreferred_capacity = 3;
+  static constexpr int external_capacity = 4;
+
+};
+
+}
+
+#endif // PEDANT_BOOSTSEPARATOR_H_
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "graphSeparator.h"
+#include "boostseparator.h"
+
+/**
+ * Compares GraphSeparator with the Boost based reference implementation and measures the time per call of both.
+ *
+ * Usage: separatorbenchmark [--random <n>] [--seed <s>] [--repetitions <r>] [<file>...]
+ *
+ * The instances are n random conflict-shaped graphs (default 20000) and the given files, which are written by
+ * GraphSeparator::saveInstance if log_conflict_graphs is set in the configuration (the .sep files next to the .dot files).
+ * Each instance is solved r times (default 10) by each implementation. The separators are compared as sets.
+ * Returns 1 if a separator differs.
+ **/
+
+namespace {
+
+using pedant::GraphSeparator;
+using pedant::BoostGraphSeparator;
+
+struct Instance {
+  std::vector<int> vertices;
+  std::vector<std::pair<int,int>> edges;
+  std::vector<int> sources;
+  std::vector<int> sinks;
+  std::vector<int> forbidden;
+  std::vector<int> unpreferred;
+};
+
+bool readInstance(const std::string& filename, Instance& instance) {
+  std::ifstream file(filename);
+  if (!file) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream values(line);
+    std::string name;
+    values >> name;
+    std::vector<int> numbers;
+    int number;
+    while (values >> number) {
+      numbers.push_back(number);
+    }
+    if (name == "vertices") {
+      instance.vertices = numbers;
+    } else if (name == "edges") {
+      for (size_t i = 0; i + 1 < numbers.size(); i += 2) {
+        instance.edges.emplace_back(numbers[i], numbers[i + 1]);
+      }
+    } else if (name == "sources") {
+      instance.sources = numbers;
+    } else if (name == "sinks") {
+      instance.sinks = numbers;
+    } else if (name == "forbidden") {
+      instance.forbidden = numbers;
+    } else if (name == "unpreferred") {
+      instance.unpreferred = numbers;
+    } else if (!name.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Mimics SupportTracker::getMinimalSeparator: the terminals (universal, arbiter and unforced existential variables)
+ * are the sources, each forced variable has edges from its support, which consists of terminals and earlier forced variables.
+ * The sinks are the variables of the conflict. Some forced variables are forbidden, some arbiters are unpreferred.
+ **/
+Instance randomInstance(std::mt19937& generator) {
+  auto uniform = [&generator](int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(generator);
+  };
+  Instance instance;
+  int nof_terminals = uniform(1, 30);
+  int nof_forced = uniform(0, 60);
+  std::vector<int> forced;
+  for (int i = 1; i <= nof_forced; i++) {
+    forced.push_back(nof_terminals + i);
+    int nof_support = uniform(1, 4);
+    for (int j = 0; j < nof_support; j++) {
+      instance.edges.emplace_back(uniform(1, nof_terminals + i - 1), nof_terminals + i);
+    }
+  }
+  for (int i = 1; i <= nof_terminals; i++) {
+    instance.sources.push_back(i);
+    if (uniform(0, 4) == 0) {
+      instance.unpreferred.push_back(i);
+    }
+  }
+  instance.vertices = forced;
+  instance.vertices.insert(instance.vertices.end(), instance.sources.begin(), instance.sources.end());
+  int nof_sinks = uniform(1, std::min(8, nof_terminals + nof_forced));
+  for (int i = 0; i < nof_sinks; i++) {
+    int sink = uniform(1, nof_terminals + nof_forced);
+    if (std::find(instance.sinks.begin(), instance.sinks.end(), sink) == instance.sinks.end()) {
+      instance.sinks.push_back(sink);
+    }
+  }
+  for (auto v : forced) {
+    if (uniform(0, 5) == 0 && std::find(instance.sinks.begin(), instance.sinks.end(), v) == instance.sinks.end()) {
+      instance.forbidden.push_back(v);
+    }
+  }
+  return instance;
+}
+
+std::vector<int> normalize(std::vector<int> separator) {
+  std::sort(separator.begin(), separator.end());
+  separator.erase(std::unique(separator.begin(), separator.end()), separator.end());
+  return separator;
+}
+
+void printVector(const std::string& name, const std::vector<int>& values) {
+  std::cerr << name << ":";
+  for (auto v : values) {
+    std::cerr << " " << v;
+  }
+  std::cerr << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+  long nof_random = 20000;
+  unsigned long seed = 1;
+  int repetitions = 10;
+  std::vector<std::string> filenames;
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    if ((argument == "--random" || argument == "--seed" || argument == "--repetitions") && i + 1 < argc) {
+      auto value = std::strtol(argv[++i], nullptr, 10);
+      if (argument == "--random") {
+        nof_random = value;
+      } else if (argument == "--seed") {
+        seed = value;
+      } else {
+        repetitions = std::max(1L, value);
+      }
+    } else if (argument.rfind("--", 0) == 0) {
+      std::cerr << "Usage: " << argv[0] << " [--random <n>] [--seed <s>] [--repetitions <r>] [<file>...]" << std::endl;
+      return 2;
+    } else {
+      filenames.push_back(argument);
+    }
+  }
+
+  std::vector<Instance> instances;
+  for (const auto& filename : filenames) {
+    Instance instance;
+    if (!readInstance(filename, instance)) {
+      std::cerr << "Could not read " << filename << "." << std::endl;
+      return 2;
+    }
+    instances.push_back(instance);
+  }
+  std::mt19937 generator(seed);
+  for (long i = 0; i < nof_random; i++) {
+    instances.push_back(randomInstance(generator));
+  }
+
+  using clock = std::chrono::steady_clock;
+  clock::duration time_csr{0}, time_boost{0};
+  size_t mismatches = 0;
+  for (size_t i = 0; i < instances.size(); i++) {
+    const auto& instance = instances[i];
+    std::vector<int> separator, reference;
+    auto start = clock::now();
+    for (int r = 0; r < repetitions; r++) {
+      separator = GraphSeparator::getVertexSeparator(instance.vertices, instance.edges, instance.sources, instance.sinks, instance.forbidden, instance.unpreferred);
+    }
+    auto middle = clock::now();
+    for (int r = 0; r < repetitions; r++) {
+      reference = BoostGraphSeparator::getVertexSeparator(instance.vertices, instance.edges, instance.sources, instance.sinks, instance.forbidden, instance.unpreferred);
+    }
+    auto end = clock::now();
+    time_csr += middle - start;
+    time_boost += end - middle;
+    if (normalize(separator) != normalize(reference)) {
+      mismatches++;
+      std::cerr << "Mismatch on " << (i < filenames.size() ? filenames[i] : "random instance " + std::to_string(i - filenames.size())) << std::endl;
+      printVector("  separator", normalize(separator));
+      printVector("  reference", normalize(reference));
+    }
+  }
+
+  auto calls = static_cast<double>(instances.size()) * repetitions;
+  auto micros = [calls](clock::duration time) {
+    return std::chrono::duration<double, std::micro>(time).count() / std::max(calls, 1.0);
+  };
+  std::cout << instances.size() << " instances, " << mismatches << " mismatches." << std::endl;
+  std::cout << "GraphSeparator:      " << micros(time_csr) << " us per call" << std::endl;
+  std::cout << "BoostGraphSeparator: " << micros(time_boost) << " us per call" << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -9,14 +9,14 @@
 PYBIND11_MODULE(utils_cc, m) {
   m.def("litFromMiniSAT", &pedant::litFromMiniSATLit);
   m.def("miniSAT_literals", &pedant::miniSATLiterals);
-  m.def("miniSAT_clauses", &pedant::miniSATClauses);
-  m.def("maxVarIndex", &pedant::maxVarIndex);
+  m.def("miniSAT_clauses", pybind11::overload_cast<std::vector<pedant::Clause>&>(&pedant::miniSATClauses));
+  m.def("maxVarIndex", pybind11::overload_cast<const std::vector<pedant::Clause>&>(&pedant::maxVarIndex));
   m.def("clausalEncodingAND", &pedant::clausalEncodingAND);
   m.def("renameLiteral", pybind11::overload_cast<int, int>(&pedant::renameLiteral));
   m.def("renameClause", &pedant::renameClause);
-  m.def("renameFormula", &pedant::renameFormula);
+  m.def("renameFormula", pybind11::overload_cast<const std::vector<pedant::Clause>&, const std::unordered_map<int, int>&>(&pedant::renameFormula));
   m.def("createRenaming", &pedant::createRenaming, pybind11::arg("clauses"), pybind11::arg("shared_variables"), pybind11::arg("auxiliary_start") = 0);
-  m.def("negate", &pedant::negateFormula, pybind11::arg("clauses"), pybind11::arg("auxiliary_start") = 0);
+  m.def("negate", pybind11::overload_cast<const std::vector<pedant::Clause>&, int&>(&pedant::negateFormula), pybind11::arg("clauses"), pybind11::arg("auxiliary_start") = 0);
   m.def("equality", &pedant::clausalEncodingEquality);
 }
 